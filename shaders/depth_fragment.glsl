@@ -0,0 +1,6 @@
+// depth_fragment.glsl
+#version 330 core
+// Depth pre-pass: colour writes are masked off, only the depth of the nearest
+// surface is written for the shading pass to match with GL_EQUAL
+void main() {
+}
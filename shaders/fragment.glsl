@@ -3,9 +3,13 @@
 out vec4 FragColor;
 in vec3 Normal;
 in vec3 FragPos;
-uniform vec3 lightPos;
-uniform vec3 viewPos;
-uniform vec3 lightColor;
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec3 lightPos;
+    vec3 viewPos;
+    vec3 lightColor;
+};
 uniform vec3 objectColor;
 void main() {
     float ambientStrength = 0.1;
@@ -0,0 +1,25 @@
+// heatmap_fragment.glsl
+#version 330 core
+// Shows fragments per pixel from blue (one) through green and yellow to red
+// (heatScale), white above it; pixels no fragment reached stay dark
+out vec4 FragColor;
+uniform sampler2D counts;   // Fragments per pixel, head in red, hair in green
+uniform int layers;         // Counts shown: 1 head, 2 hair, 3 both
+uniform int heatScale;      // Count shown as the hottest colour
+const vec3 stops[5] = vec3[5](vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 1.0), vec3(0.0, 1.0, 0.0),
+    vec3(1.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0));
+void main() {
+    vec2 pixel = texelFetch(counts, ivec2(gl_FragCoord.xy), 0).rg;
+    float count = ((layers & 1) != 0 ? pixel.r : 0.0) + ((layers & 2) != 0 ? pixel.g : 0.0);
+    if (count < 0.5) {
+        FragColor = vec4(0.05, 0.05, 0.05, 1.0);
+        return;
+    }
+    if (count > float(heatScale) + 0.5) {
+        FragColor = vec4(1.0);
+        return;
+    }
+    float x = clamp((count - 1.0) / max(float(heatScale) - 1.0, 1.0), 0.0, 1.0) * 4.0;
+    int i = min(int(x), 3);
+    FragColor = vec4(mix(stops[i], stops[i + 1], x - float(i)), 1.0);
+}
@@ -0,0 +1,9 @@
+// overdraw_fragment.glsl
+#version 330 core
+// Overdraw counting: with additive blending every rasterized fragment adds one
+// to its model's channel, head in red and hair in green
+out vec4 FragColor;
+uniform vec3 channel;
+void main() {
+    FragColor = vec4(channel, 0.0);
+}
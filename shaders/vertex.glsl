@@ -4,11 +4,34 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 out vec3 FragPos;
 out vec3 Normal;
+// The depth pre-pass runs this shader in another program, its depth must match bit for bit
+invariant gl_Position;
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Inverse transpose of the model matrix, computed once per draw on the CPU
+uniform mat3 normalMatrix;
+// Per-frame data shared by all draws, std140 layout of FrameData in frame_uniforms.h
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec3 lightPos;
+    vec3 viewPos;
+    vec3 lightColor;
+};
+// Compact meshes: quantized positions and octahedral normals, identity otherwise
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+uniform bool octahedralNormals;
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
 void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    vec3 position = positionOffset + aPos * positionScale;
+    vec3 normal = octahedralNormals ? decodeOctahedral(aNormal.xy) : aNormal;
+    FragPos = vec3(model * vec4(position, 1.0));
+    Normal = normalMatrix * normal;
+    gl_Position = projection * view * model * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -27,6 +27,7 @@ SOFTWARE.
 */
 
 #include "ImGuiFileDialog.h"
+#include "profiler.h"
 
 #ifdef __cplusplus
 
@@ -2046,6 +2047,7 @@ void IGFD::FileManager::m_AddPath(const FileDialogInternal& vFileDialogInternal,
 }
 
 void IGFD::FileManager::ScanDir(const FileDialogInternal& vFileDialogInternal, const std::string& vPath) {
+    PROFILE_SCOPE("IGFD::FileManager::ScanDir");
     std::string path = vPath;
 
     if (m_CurrentPathDecomposition.empty()) {
@@ -2065,6 +2067,7 @@ void IGFD::FileManager::ScanDir(const FileDialogInternal& vFileDialogInternal, c
         for (const auto& file : files) {
             m_AddFile(vFileDialogInternal, path, file.fileNameExt, file.fileType);
         }
+        PROFILE_COUNTER("Dialog files", files.size());
 
         m_SortFields(vFileDialogInternal, m_FileList, m_FilteredFileList);
     }
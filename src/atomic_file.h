@@ -0,0 +1,197 @@
+#ifndef ATOMIC_FILE_H
+#define ATOMIC_FILE_H
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Crash-safe whole-file replacement: the data goes to a temporary file next to
+// the target, is flushed to disk and then renamed over the target, so readers
+// and crashes only ever see the old or the new complete file.
+namespace AtomicFile {
+
+// Temporary file used while replacing path
+inline std::filesystem::path tempPath(const std::filesystem::path& path) {
+    std::filesystem::path temp = path;
+    temp += ".saving";
+    return temp;
+}
+
+// Streams a new version of a file through a fixed-size buffer into the
+// temporary file. commit() makes it replace the target, destroying the writer
+// without a successful commit discards it and leaves the target untouched.
+class Writer {
+public:
+    // Default number of bytes collected before they are handed to the OS
+    static constexpr size_t BufferSize = 4 * 1024 * 1024;
+
+private:
+    std::filesystem::path target;       // File being replaced
+    std::filesystem::path temp;         // Temporary file receiving the data
+    std::vector<char> buffer;           // Pending bytes, its size is the capacity
+    size_t used;                        // Bytes used in buffer
+    bool ok;                            // False after any failure
+#ifdef _WIN32
+    HANDLE file;                        // Handle of the temporary file
+#else
+    int file;                           // Descriptor of the temporary file
+#endif
+
+public:
+    // A bufferSize of 0 writes every block straight through
+    explicit Writer(const std::string& path, size_t bufferSize = BufferSize)
+        : target(path),
+        temp(tempPath(target)),
+        buffer(bufferSize),
+        used(0),
+        ok(true) {
+#ifdef _WIN32
+        file = CreateFileW(temp.wstring().c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+        ok = file != INVALID_HANDLE_VALUE;
+#else
+        file = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ok = file >= 0;
+#endif
+    }
+
+    ~Writer() {
+        closeFile();
+        if (!temp.empty()) {
+            // Not committed: drop the partial temporary file
+            std::error_code ec;
+            std::filesystem::remove(temp, ec);
+        }
+    }
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // Whether every operation so far succeeded
+    bool good() const { return ok; }
+
+    // Appends bytes, large blocks bypass the buffer
+    void write(const void* data, size_t size) {
+        if (!ok || size == 0) return;
+        if (used + size <= buffer.size()) {
+            std::memcpy(buffer.data() + used, data, size);
+            used += size;
+            return;
+        }
+        flushBuffer();
+        if (size >= buffer.size()) {
+            writeRaw(static_cast<const char*>(data), size);
+        }
+        else {
+            std::memcpy(buffer.data(), data, size);
+            used = size;
+        }
+    }
+
+    // Writes the rest, flushes to disk unless durable is false and renames the
+    // temporary file over the target. Returns false if anything failed.
+    bool commit(bool durable = true) {
+        flushBuffer();
+#ifdef _WIN32
+        ok = ok && (!durable || FlushFileBuffers(file));
+        bool closed = closeFile();
+        ok = ok && closed && MoveFileExW(temp.wstring().c_str(), target.wstring().c_str(),
+            MOVEFILE_REPLACE_EXISTING | (durable ? MOVEFILE_WRITE_THROUGH : 0));
+#else
+        ok = ok && (!durable || ::fsync(file) == 0);
+        bool closed = closeFile();
+        ok = ok && closed && ::rename(temp.c_str(), target.c_str()) == 0;
+        if (ok && durable) {
+            // Persist the rename itself
+            std::filesystem::path parent = target.parent_path();
+            int directory = ::open(parent.empty() ? "." : parent.c_str(), O_RDONLY);
+            if (directory >= 0) {
+                ::fsync(directory);
+                ::close(directory);
+            }
+        }
+#endif
+        if (ok) {
+            temp.clear();
+        }
+        return ok;
+    }
+
+private:
+    // Hands the buffered bytes to the OS
+    void flushBuffer() {
+        if (ok && used > 0) {
+            writeRaw(buffer.data(), used);
+        }
+        used = 0;
+    }
+
+    // Writes a block directly to the temporary file
+    void writeRaw(const char* bytes, size_t size) {
+#ifdef _WIN32
+        while (ok && size > 0) {
+            DWORD chunk = static_cast<DWORD>(size < 0x40000000u ? size : 0x40000000u);
+            DWORD written = 0;
+            ok = WriteFile(file, bytes, chunk, &written, nullptr) && written > 0;
+            bytes += written;
+            size -= written;
+        }
+#else
+        while (ok && size > 0) {
+            ssize_t written = ::write(file, bytes, size);
+            if (written < 0 && errno == EINTR) continue;
+            ok = written > 0;
+            if (ok) {
+                bytes += written;
+                size -= static_cast<size_t>(written);
+            }
+        }
+#endif
+    }
+
+    // Closes the temporary file, returns false if it failed or was not open
+    bool closeFile() {
+#ifdef _WIN32
+        if (file == INVALID_HANDLE_VALUE) return false;
+        bool closed = CloseHandle(file) != 0;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (file < 0) return false;
+        bool closed = ::close(file) == 0;
+        file = -1;
+#endif
+        return closed;
+    }
+};
+
+// Replaces the file at path with the given bytes, returns false on any failure
+// in which case the original file is left untouched. Without durable the flush
+// is skipped: the rename still protects against application crashes, but a
+// power loss may lose the new contents.
+inline bool write(const std::string& path, const void* data, size_t size, bool durable = true) {
+    Writer writer(path, 0);
+    writer.write(data, size);
+    return writer.commit(durable);
+}
+
+} // namespace AtomicFile
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <glm/glm.hpp>
+#include <rapidjson/document.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mesh_data.h"
+#include "model.h"
+#include "placement.h"
+
+// Headless batch export: loads hair models, bakes their placements in and writes
+// them in the format given by each output extension, without a window or GL
+// context. Jobs sharing a model are grouped so each model is loaded once, and
+// the groups run in parallel on worker threads taking work from a shared counter.
+// Models are loaded for export only (no LODs or meshlets) and stay out of the
+// viewer's mesh cache unless asked, so a large run does not evict its entries.
+//
+// Job file layout, relative paths are resolved against the job file's directory:
+// { "jobs": [ { "model": "hair.obj", "output": "out/hair.glb",
+//               "placement": <object like a placement sidecar, or path to one>,
+//               "objPrecision": 6, "positionBits": 14, "normalBits": 10 } ] }
+// Without "placement" the model's own sidecar ("<model>.placement.json") is used.
+class BatchRunner {
+private:
+    // One export, parsed from the job file
+    struct Job {
+        std::string model;          // Hair model to load
+        std::string output;         // Target file, its extension selects the format
+        glm::mat4 transform;        // Placement baked into the written vertices
+        uint64_t placementHash;     // Content hash the placement was made for, 0 if unknown
+        SaveSettings settings;      // Output settings
+        std::string error;          // Why the entry is unusable, empty if valid
+    };
+
+    // Jobs sharing one model, the unit of work of a worker
+    struct Group {
+        std::string model;
+        std::vector<size_t> jobs;   // Indices into the job list
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+public:
+    // Runs all jobs of a job file with the given number of workers, 0 for one per
+    // core; storeInCache also adds the loaded models to the mesh cache. Returns the
+    // process exit code: 0 if every job succeeded, 1 otherwise.
+    static int run(const std::string& jobFile, unsigned int threadCount = 0, bool storeInCache = false) {
+        std::vector<Job> jobs;
+        if (!readJobs(jobFile, jobs)) {
+            return 1;
+        }
+        if (jobs.empty()) {
+            std::cout << "Batch: no jobs in " << jobFile << std::endl;
+            return 0;
+        }
+
+        // Group by model in job file order
+        std::vector<Group> groups;
+        std::map<std::string, size_t> groupIndex;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            auto found = groupIndex.emplace(jobs[i].model, groups.size());
+            if (found.second) {
+                groups.push_back({ jobs[i].model, {} });
+            }
+            groups[found.first->second].jobs.push_back(i);
+        }
+
+        const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+        if (threadCount == 0) {
+            threadCount = cores;
+        }
+        threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, groups.size()));
+        // Each worker gets its share of the cores for the OBJ reader and formatter,
+        // so fewer models than cores still use them all and more never oversubscribe
+        const unsigned int exportThreads = std::max(1u, cores / threadCount);
+        std::cout << "Batch: " << jobs.size() << " jobs on " << groups.size() << " models, "
+            << threadCount << " workers" << std::endl;
+
+        const Clock::time_point start = Clock::now();
+        std::mutex reportMutex;
+        std::atomic<size_t> next(0), failed(0);
+        auto work = [&]() {
+            for (size_t g = next++; g < groups.size(); g = next++) {
+                failed += runGroup(groups[g], jobs, exportThreads, storeInCache, reportMutex);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned int t = 1; t < threadCount; t++) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) worker.join();
+
+        std::cout << "Batch: " << jobs.size() - failed << " of " << jobs.size() << " jobs succeeded in "
+            << std::fixed << std::setprecision(2) << seconds(start, Clock::now()) << " s" << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+
+private:
+    // Loads a model once and runs its exports, returns the number of failed jobs
+    static size_t runGroup(const Group& group, const std::vector<Job>& jobs, unsigned int exportThreads,
+        bool storeInCache, std::mutex& reportMutex) {
+        // Entries that could not be parsed fail without loading anything
+        std::vector<size_t> valid;
+        size_t failures = 0;
+        for (size_t index : group.jobs) {
+            if (jobs[index].error.empty()) {
+                valid.push_back(index);
+            }
+            else {
+                report(reportMutex, jobs[index], false, 0.0, 0.0, jobs[index].error);
+                failures++;
+            }
+        }
+        if (valid.empty()) {
+            return failures;
+        }
+
+        const Clock::time_point loadStart = Clock::now();
+        uint64_t contentHash = 0;
+        std::vector<MeshData> meshes = Model::loadMeshDataForExport(group.model, &contentHash, exportThreads, storeInCache);
+        const double loadSeconds = seconds(loadStart, Clock::now());
+
+        for (size_t index : valid) {
+            const Job& job = jobs[index];
+            if (meshes.empty()) {
+                report(reportMutex, job, false, loadSeconds, 0.0, "cannot load model");
+                failures++;
+                continue;
+            }
+            std::string warning;
+            if (job.placementHash != 0 && contentHash != 0 && job.placementHash != contentHash) {
+                warning = "model changed since its placement was saved";
+            }
+
+            const Clock::time_point exportStart = Clock::now();
+            std::error_code ec;
+            std::filesystem::path parent = std::filesystem::path(job.output).parent_path();
+            if (!parent.empty()) {
+                std::filesystem::create_directories(parent, ec);
+            }
+            bool ok = Model::saveMeshData(meshes, job.output, job.transform, job.settings, nullptr, exportThreads);
+            report(reportMutex, job, ok, loadSeconds, seconds(exportStart, Clock::now()),
+                ok ? warning : "cannot write output");
+            if (!ok) {
+                failures++;
+            }
+        }
+        return failures;
+    }
+
+    // Prints the outcome of one job
+    static void report(std::mutex& reportMutex, const Job& job, bool ok, double loadSeconds, double exportSeconds,
+        const std::string& message) {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        std::cout << (ok ? "  ok     " : "  FAILED ") << job.model << " -> " << job.output
+            << std::fixed << std::setprecision(1)
+            << "  (load " << loadSeconds * 1000.0 << " ms, export " << exportSeconds * 1000.0 << " ms)";
+        if (!message.empty()) {
+            std::cout << ": " << message;
+        }
+        std::cout << std::endl;
+    }
+
+    // Parses the job file, returns false if it cannot be used at all. Invalid
+    // entries become jobs carrying an error so they show up in the report.
+    static bool readJobs(const std::string& jobFile, std::vector<Job>& jobs) {
+        std::ifstream file(jobFile, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            std::cout << "Batch: cannot open " << jobFile << std::endl;
+            return false;
+        }
+        std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        rapidjson::Document document;
+        document.Parse(json.c_str());
+        if (document.HasParseError() || !document.IsObject() ||
+            !document.HasMember("jobs") || !document["jobs"].IsArray()) {
+            std::cout << "Batch: " << jobFile << " is not a job file with a \"jobs\" array" << std::endl;
+            return false;
+        }
+
+        const std::filesystem::path base = std::filesystem::path(jobFile).parent_path();
+        for (const auto& entry : document["jobs"].GetArray()) {
+            jobs.push_back(readJob(entry, base));
+        }
+        return true;
+    }
+
+    // Parses one job entry
+    static Job readJob(const rapidjson::Value& entry, const std::filesystem::path& base) {
+        Job job;
+        job.transform = glm::mat4(1.0f);
+        job.placementHash = 0;
+        if (!entry.IsObject()) {
+            job.error = "job entry is not an object";
+            return job;
+        }
+        if (entry.HasMember("model") && entry["model"].IsString()) {
+            job.model = resolve(base, entry["model"].GetString());
+        }
+        if (entry.HasMember("output") && entry["output"].IsString()) {
+            job.output = resolve(base, entry["output"].GetString());
+        }
+        if (job.model.empty() || job.output.empty()) {
+            job.error = "job needs \"model\" and \"output\"";
+            return job;
+        }
+
+        Placement placement;
+        if (entry.HasMember("placement") && entry["placement"].IsObject()) {
+            if (!placement.readTransform(entry["placement"])) {
+                job.error = "invalid inline placement";
+                return job;
+            }
+        }
+        else {
+            std::string placementPath = Placement::sidecarPath(job.model);
+            if (entry.HasMember("placement") && entry["placement"].IsString()) {
+                placementPath = resolve(base, entry["placement"].GetString());
+            }
+            if (!placement.load(placementPath)) {
+                job.error = "cannot read placement " + placementPath;
+                return job;
+            }
+        }
+        job.transform = placement.getModelMatrix();
+        job.placementHash = placement.contentHash;
+
+        readInt(entry, "objPrecision", job.settings.objPrecision);
+        readInt(entry, "positionBits", job.settings.draco.positionBits);
+        readInt(entry, "normalBits", job.settings.draco.normalBits);
+        return job;
+    }
+
+    // Path relative to the job file's directory unless it is absolute
+    static std::string resolve(const std::filesystem::path& base, const std::string& path) {
+        std::filesystem::path value(path);
+        return (value.is_absolute() ? value : base / value).lexically_normal().string();
+    }
+
+    static void readInt(const rapidjson::Value& object, const char* name, int& value) {
+        if (object.HasMember(name) && object[name].IsInt()) {
+            value = object[name].GetInt();
+        }
+    }
+
+    static double seconds(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double>(to - from).count();
+    }
+};
+
+#endif
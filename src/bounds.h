@@ -0,0 +1,107 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "mesh_data.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define BOUNDS_USE_SSE 1
+#endif
+
+// Axis-aligned box and enclosing sphere of a set of points
+struct Bounds {
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());    // Minimum coordinates
+    glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest()); // Maximum coordinates
+    glm::vec3 center = glm::vec3(0.0f);                              // Sphere center, the box center
+    float radius = 0.0f;                                             // Sphere radius, half the box diagonal
+
+    // True until a point has been added
+    bool empty() const { return min.x > max.x; }
+
+    // Grows the box to contain another box and updates the sphere
+    void merge(const Bounds& other) {
+        if (other.empty()) {
+            return;
+        }
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+        updateSphere();
+    }
+
+    // Derives the sphere from the box
+    void updateSphere() {
+        center = (min + max) * 0.5f;
+        radius = glm::length(max - min) * 0.5f;
+    }
+};
+
+// Bounds of all vertex positions in one pass over the vertices
+inline Bounds computeBounds(const std::vector<Vertex>& vertices) {
+    Bounds bounds;
+    if (vertices.empty()) {
+        return bounds;
+    }
+#ifdef BOUNDS_USE_SSE
+    // Each load takes the position plus Normal.x, the fourth lane is ignored.
+    // Two accumulator pairs keep the min/max dependency chains short.
+    const float* data = &vertices[0].Position.x;
+    const size_t stride = sizeof(Vertex) / sizeof(float);
+    __m128 min0 = _mm_loadu_ps(data), max0 = min0, min1 = min0, max1 = min0;
+    size_t i = 0;
+    for (; i + 2 <= vertices.size(); i += 2) {
+        __m128 a = _mm_loadu_ps(data + i * stride);
+        __m128 b = _mm_loadu_ps(data + (i + 1) * stride);
+        min0 = _mm_min_ps(min0, a);
+        max0 = _mm_max_ps(max0, a);
+        min1 = _mm_min_ps(min1, b);
+        max1 = _mm_max_ps(max1, b);
+    }
+    if (i < vertices.size()) {
+        __m128 a = _mm_loadu_ps(data + i * stride);
+        min0 = _mm_min_ps(min0, a);
+        max0 = _mm_max_ps(max0, a);
+    }
+    float minimum[4], maximum[4];
+    _mm_storeu_ps(minimum, _mm_min_ps(min0, min1));
+    _mm_storeu_ps(maximum, _mm_max_ps(max0, max1));
+    bounds.min = glm::vec3(minimum[0], minimum[1], minimum[2]);
+    bounds.max = glm::vec3(maximum[0], maximum[1], maximum[2]);
+#else
+    for (const auto& vertex : vertices) {
+        bounds.min = glm::min(bounds.min, vertex.Position);
+        bounds.max = glm::max(bounds.max, vertex.Position);
+    }
+#endif
+    bounds.updateSphere();
+    return bounds;
+}
+
+// Bounds after an affine transform, computed from the box alone (Arvo): the new
+// half extents are the absolute matrix applied to the old ones
+inline Bounds transformBounds(const Bounds& bounds, const glm::mat4& transform) {
+    if (bounds.empty()) {
+        return bounds;
+    }
+    glm::vec3 center = glm::vec3(transform * glm::vec4((bounds.min + bounds.max) * 0.5f, 1.0f));
+    glm::vec3 extent = (bounds.max - bounds.min) * 0.5f;
+    glm::mat3 linear = glm::mat3(transform);
+    glm::vec3 transformedExtent(0.0f);
+    for (int column = 0; column < 3; column++) {
+        transformedExtent += glm::abs(linear[column]) * extent[column];
+    }
+    Bounds result;
+    result.min = center - transformedExtent;
+    result.max = center + transformedExtent;
+    // The sphere keeps its own size, scaled by the largest axis scale
+    float scale = std::max(glm::length(linear[0]), std::max(glm::length(linear[1]), glm::length(linear[2])));
+    result.center = glm::vec3(transform * glm::vec4(bounds.center, 1.0f));
+    result.radius = bounds.radius * scale;
+    return result;
+}
+
+#endif
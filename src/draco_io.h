@@ -0,0 +1,147 @@
+#ifndef DRACO_IO_H
+#define DRACO_IO_H
+
+#include <glm/glm.hpp>
+#include <draco/compression/decode.h>
+#include <draco/compression/encode.h>
+#include <draco/core/decoder_buffer.h>
+#include <draco/core/encoder_buffer.h>
+#include <draco/mesh/mesh.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "mesh_data.h"
+#include "mapped_file.h"
+#include "atomic_file.h"
+
+// Reading and writing of Draco-compressed meshes (.drc)
+namespace DracoIO {
+
+// Encoder settings, more quantization bits mean higher precision and larger files
+struct Settings {
+    int positionBits = 14;  // Position quantization bits (1-30)
+    int normalBits = 10;    // Normal quantization bits (1-30)
+    int encodingSpeed = 5;  // 0 = best compression, 10 = fastest encoding
+    int decodingSpeed = 5;  // 0 = best compression, 10 = fastest decoding
+};
+
+// Decodes a .drc file into a single mesh, returns false on failure
+inline bool read(const std::string& path, std::vector<MeshData>& meshes) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    draco::DecoderBuffer buffer;
+    buffer.Init(reinterpret_cast<const char*>(file.data()), file.size());
+    draco::Decoder decoder;
+    auto decoded = decoder.DecodeMeshFromBuffer(&buffer);
+    if (!decoded.ok()) {
+        std::cout << "Draco decode failed: " << decoded.status().error_msg_string() << std::endl;
+        return false;
+    }
+    const std::unique_ptr<draco::Mesh>& dracoMesh = decoded.value();
+    const draco::PointAttribute* positions = dracoMesh->GetNamedAttribute(draco::GeometryAttribute::POSITION);
+    const draco::PointAttribute* normals = dracoMesh->GetNamedAttribute(draco::GeometryAttribute::NORMAL);
+    if (!positions || dracoMesh->num_faces() == 0) {
+        return false;
+    }
+
+    // Decode attributes straight into the interleaved vertex array
+    MeshData mesh;
+    mesh.vertices.resize(dracoMesh->num_points());
+    for (draco::PointIndex i(0); i < dracoMesh->num_points(); ++i) {
+        Vertex& vertex = mesh.vertices[i.value()];
+        positions->ConvertValue<float, 3>(positions->mapped_index(i), &vertex.Position.x);
+        if (normals) {
+            normals->ConvertValue<float, 3>(normals->mapped_index(i), &vertex.Normal.x);
+            vertex.Normal = validNormal(vertex.Normal);
+        }
+    }
+
+    mesh.indices.resize(static_cast<size_t>(dracoMesh->num_faces()) * 3);
+    for (draco::FaceIndex f(0); f < dracoMesh->num_faces(); ++f) {
+        const draco::Mesh::Face& face = dracoMesh->face(f);
+        for (int k = 0; k < 3; k++) {
+            mesh.indices[f.value() * 3 + k] = face[k].value();
+        }
+    }
+    if (!normals) {
+        computeSmoothNormals(mesh);
+    }
+
+    meshes.clear();
+    meshes.push_back(std::move(mesh));
+    return true;
+}
+
+// Encodes all meshes with the transform applied into a single Draco mesh
+inline bool encode(const std::vector<MeshData>& meshes, const glm::mat4& transform, const Settings& settings,
+    draco::EncoderBuffer& buffer) {
+    size_t vertexCount = 0, faceCount = 0;
+    for (const auto& mesh : meshes) {
+        vertexCount += mesh.vertices.size();
+        faceCount += mesh.indices.size() / 3;
+    }
+    if (vertexCount == 0 || faceCount == 0) {
+        return false;
+    }
+
+    draco::Mesh dracoMesh;
+    dracoMesh.set_num_points(static_cast<uint32_t>(vertexCount));
+    draco::GeometryAttribute positionAttribute;
+    positionAttribute.Init(draco::GeometryAttribute::POSITION, nullptr, 3, draco::DT_FLOAT32, false,
+        sizeof(float) * 3, 0);
+    int positionId = dracoMesh.AddAttribute(positionAttribute, true, static_cast<uint32_t>(vertexCount));
+    draco::GeometryAttribute normalAttribute;
+    normalAttribute.Init(draco::GeometryAttribute::NORMAL, nullptr, 3, draco::DT_FLOAT32, false,
+        sizeof(float) * 3, 0);
+    int normalId = dracoMesh.AddAttribute(normalAttribute, true, static_cast<uint32_t>(vertexCount));
+    draco::PointAttribute* positions = dracoMesh.attribute(positionId);
+    draco::PointAttribute* normals = dracoMesh.attribute(normalId);
+
+    glm::mat3 normalTransform = normalMatrix(transform);
+    uint32_t base = 0;
+    dracoMesh.SetNumFaces(faceCount);
+    draco::FaceIndex face(0);
+    for (const auto& mesh : meshes) {
+        for (size_t i = 0; i < mesh.vertices.size(); i++) {
+            glm::vec3 position = glm::vec3(transform * glm::vec4(mesh.vertices[i].Position, 1.0f));
+            glm::vec3 normal = glm::normalize(normalTransform * mesh.vertices[i].Normal);
+            positions->SetAttributeValue(draco::AttributeValueIndex(base + static_cast<uint32_t>(i)), &position.x);
+            normals->SetAttributeValue(draco::AttributeValueIndex(base + static_cast<uint32_t>(i)), &normal.x);
+        }
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+            draco::Mesh::Face triangle = { draco::PointIndex(base + mesh.indices[i]),
+                draco::PointIndex(base + mesh.indices[i + 1]), draco::PointIndex(base + mesh.indices[i + 2]) };
+            dracoMesh.SetFace(face, triangle);
+            ++face;
+        }
+        base += static_cast<uint32_t>(mesh.vertices.size());
+    }
+
+    draco::Encoder encoder;
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, settings.positionBits);
+    encoder.SetAttributeQuantization(draco::GeometryAttribute::NORMAL, settings.normalBits);
+    encoder.SetSpeedOptions(settings.encodingSpeed, settings.decodingSpeed);
+    draco::Status status = encoder.EncodeMeshToBuffer(dracoMesh, &buffer);
+    if (!status.ok()) {
+        std::cout << "Draco encode failed: " << status.error_msg_string() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Encodes all meshes into a .drc file, atomically replacing any existing file
+inline bool write(const std::string& path, const std::vector<MeshData>& meshes, const glm::mat4& transform,
+    const Settings& settings = Settings()) {
+    draco::EncoderBuffer buffer;
+    if (!encode(meshes, transform, settings, buffer)) {
+        return false;
+    }
+    return AtomicFile::write(path, buffer.data(), buffer.size());
+}
+
+} // namespace DracoIO
+
+#endif
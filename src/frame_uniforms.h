@@ -0,0 +1,71 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include "gl_handle.h"
+#include "gl_diagnostics.h"
+#include "shader.h"
+
+// Per-frame shader inputs, laid out like the std140 "FrameData" block in the shaders
+struct FrameData {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec4 lightPos;     // xyz used, std140 pads vec3 to 16 bytes
+    glm::vec4 viewPos;      // xyz used
+    glm::vec4 lightColor;   // xyz used
+};
+
+static_assert(offsetof(FrameData, view) == 64 && offsetof(FrameData, lightPos) == 128 &&
+    offsetof(FrameData, viewPos) == 144 && offsetof(FrameData, lightColor) == 160 && sizeof(FrameData) == 176,
+    "FrameData must match the std140 layout of the shader block");
+
+// Uniform buffer holding FrameData, bound once to a fixed binding point that
+// every program's block is connected to. Updated once per frame, and only when
+// the camera or light actually changed.
+class FrameUniforms {
+public:
+    static constexpr GLuint BindingPoint = 0;
+    static constexpr const char* BlockName = "FrameData";
+
+private:
+    GLBuffer buffer;        // Uniform buffer object
+    FrameData current;      // Contents of the buffer
+    bool hasData;           // Whether the buffer has been filled
+
+public:
+    FrameUniforms()
+        : buffer(GLBuffer::create()),
+        current(),
+        hasData(false) {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer.get());
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        GLDiagnostics::label(GL_BUFFER, buffer.get(), "FrameData uniforms");
+        glBindBufferBase(GL_UNIFORM_BUFFER, BindingPoint, buffer.get());
+    }
+
+    // Connects a program's FrameData block to the buffer
+    void attach(Shader& shader) const {
+        if (!shader.bindUniformBlock(BlockName, BindingPoint)) {
+            std::cout << "Shader program has no " << BlockName << " uniform block" << std::endl;
+        }
+    }
+
+    // Uploads the frame data unless it equals what the buffer already holds
+    void update(const FrameData& data) {
+        if (hasData && std::memcmp(&current, &data, sizeof(FrameData)) == 0) {
+            return;
+        }
+        current = data;
+        hasData = true;
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer.get());
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &current);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+};
+
+#endif
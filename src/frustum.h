@@ -0,0 +1,86 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+#include <array>
+#include "bounds.h"
+
+// View frustum as six inward-facing planes (ax + by + cz + d >= 0 inside),
+// extracted from a clip matrix (Gribb/Hartmann). Extracting from
+// projection * view * model gives the planes in the model's object space, so
+// object-space bounds can be tested without transforming them.
+struct Frustum {
+    // Result of testing a volume against the frustum
+    enum class Containment { Outside, Intersecting, Inside };
+
+    std::array<glm::vec4, 6> planes;    // Left, right, bottom, top, near, far
+
+    // Extracts the planes of a clip matrix, normalized so plane distances are
+    // in the units of the matrix's input space
+    static Frustum fromMatrix(const glm::mat4& clip) {
+        // Rows of the column-major matrix
+        const glm::vec4 row0(clip[0][0], clip[1][0], clip[2][0], clip[3][0]);
+        const glm::vec4 row1(clip[0][1], clip[1][1], clip[2][1], clip[3][1]);
+        const glm::vec4 row2(clip[0][2], clip[1][2], clip[2][2], clip[3][2]);
+        const glm::vec4 row3(clip[0][3], clip[1][3], clip[2][3], clip[3][3]);
+        Frustum frustum;
+        frustum.planes = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+        for (auto& plane : frustum.planes) {
+            float length = glm::length(glm::vec3(plane));
+            if (length > 0.0f) {
+                plane /= length;
+            }
+        }
+        return frustum;
+    }
+
+    // Classifies bounds by their sphere first, which settles most cases with one
+    // dot product per plane, and only tests the box where the sphere straddles a plane
+    Containment classify(const Bounds& bounds) const {
+        if (bounds.empty()) {
+            return Containment::Outside;
+        }
+        Containment result = Containment::Inside;
+        for (const auto& plane : planes) {
+            const glm::vec3 normal(plane);
+            const float distance = glm::dot(normal, bounds.center) + plane.w;
+            if (distance >= bounds.radius) {
+                continue;
+            }
+            if (distance < -bounds.radius) {
+                return Containment::Outside;
+            }
+            // Box corners farthest along and against the plane normal
+            const glm::vec3 positive(normal.x >= 0.0f ? bounds.max.x : bounds.min.x,
+                normal.y >= 0.0f ? bounds.max.y : bounds.min.y,
+                normal.z >= 0.0f ? bounds.max.z : bounds.min.z);
+            if (glm::dot(normal, positive) + plane.w < 0.0f) {
+                return Containment::Outside;
+            }
+            const glm::vec3 negative(normal.x >= 0.0f ? bounds.min.x : bounds.max.x,
+                normal.y >= 0.0f ? bounds.min.y : bounds.max.y,
+                normal.z >= 0.0f ? bounds.min.z : bounds.max.z);
+            if (glm::dot(normal, negative) + plane.w < 0.0f) {
+                result = Containment::Intersecting;
+            }
+        }
+        return result;
+    }
+
+    // Whether any part of a sphere may be visible
+    bool intersectsSphere(const glm::vec3& center, float radius) const {
+        for (const auto& plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Whether any part of the bounds may be visible
+    bool intersects(const Bounds& bounds) const {
+        return classify(bounds) != Containment::Outside;
+    }
+};
+
+#endif
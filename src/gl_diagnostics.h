@@ -0,0 +1,202 @@
+#ifndef GL_DIAGNOSTICS_H
+#define GL_DIAGNOSTICS_H
+
+#include <glad/glad.h>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+// OpenGL error reporting through KHR_debug, replacing glGetError polling. The
+// mode is chosen once at startup:
+//   Off      - nothing is installed, the render loop pays nothing (release default)
+//   Callback - the driver reports errors, warnings and performance issues to a
+//              callback; repeated messages are printed once (debug default)
+//   Sync     - like Callback, but messages are delivered inside the offending
+//              GL call so a breakpoint in the callback shows the culprit
+// Objects labelled through label() appear by name in driver messages.
+class GLDiagnostics {
+public:
+    enum class Mode { Off, Callback, Sync };
+
+private:
+    // Message identity used for deduplication
+    using MessageKey = std::pair<GLuint, std::string>;
+
+    // Process-wide state, the callback may run on driver threads
+    struct State {
+        Mode mode = Mode::Off;
+        PFNGLOBJECTLABELPROC objectLabel = nullptr;    // Null unless diagnostics are active
+        std::mutex mutex;                              // Guards counts
+        std::map<MessageKey, unsigned long> counts;    // Occurrences per distinct message
+    };
+
+    static State& state() {
+        static State instance;
+        return instance;
+    }
+
+public:
+    // Mode used when none is given on the command line
+    static Mode defaultMode() {
+#ifdef NDEBUG
+        return Mode::Off;
+#else
+        return Mode::Callback;
+#endif
+    }
+
+    // Parses "off", "callback" or "sync", returns false for anything else
+    static bool parseMode(const std::string& text, Mode& mode) {
+        if (text == "off") mode = Mode::Off;
+        else if (text == "callback") mode = Mode::Callback;
+        else if (text == "sync") mode = Mode::Sync;
+        else return false;
+        return true;
+    }
+
+    // Installs the debug callback after GLAD has been loaded. loader resolves
+    // the KHR_debug entry points glad only loads on 4.3 contexts. Returns false
+    // if the mode needs KHR_debug and the driver lacks it, diagnostics are then off.
+    static bool initialize(Mode mode, GLADloadproc loader) {
+        State& s = state();
+        s.mode = Mode::Off;
+        if (mode == Mode::Off) {
+            return true;
+        }
+
+        PFNGLDEBUGMESSAGECALLBACKPROC debugMessageCallback = glad_glDebugMessageCallback;
+        PFNGLDEBUGMESSAGECONTROLPROC debugMessageControl = glad_glDebugMessageControl;
+        PFNGLOBJECTLABELPROC objectLabel = glad_glObjectLabel;
+        if (!debugMessageCallback && hasExtension("GL_KHR_debug")) {
+            debugMessageCallback = reinterpret_cast<PFNGLDEBUGMESSAGECALLBACKPROC>(loader("glDebugMessageCallback"));
+            debugMessageControl = reinterpret_cast<PFNGLDEBUGMESSAGECONTROLPROC>(loader("glDebugMessageControl"));
+            objectLabel = reinterpret_cast<PFNGLOBJECTLABELPROC>(loader("glObjectLabel"));
+        }
+        if (!debugMessageCallback || !debugMessageControl) {
+            std::cout << "GL diagnostics: KHR_debug is not available, diagnostics are off" << std::endl;
+            return false;
+        }
+
+        GLint flags = 0;
+        glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+        if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) {
+            std::cout << "GL diagnostics: not a debug context, the driver may report little" << std::endl;
+        }
+
+        glEnable(GL_DEBUG_OUTPUT);
+        if (mode == Mode::Sync) {
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        }
+        else {
+            glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        }
+        // Filtered in the driver: informational chatter such as buffer placement
+        // hints, and compiler output that Shader already prints
+        debugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+        debugMessageControl(GL_DEBUG_SOURCE_SHADER_COMPILER, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+        debugMessageCallback(&onMessage, nullptr);
+
+        s.objectLabel = objectLabel;
+        s.mode = mode;
+        std::cout << "GL diagnostics: " << (mode == Mode::Sync ? "synchronous" : "callback") << " mode" << std::endl;
+        return true;
+    }
+
+    // Reports how often repeated messages occurred and stops delivering them,
+    // call while the context is still current
+    static void shutdown() {
+        State& s = state();
+        if (s.mode == Mode::Off) {
+            return;
+        }
+        glDisable(GL_DEBUG_OUTPUT);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (const auto& entry : s.counts) {
+            if (entry.second > 1) {
+                std::cout << "GL diagnostics: message " << entry.first.first << " repeated "
+                    << entry.second << " times" << std::endl;
+            }
+        }
+        s.counts.clear();
+        s.objectLabel = nullptr;
+        s.mode = Mode::Off;
+    }
+
+    // Names a GL object for driver messages and debuggers. The object must have
+    // been bound or otherwise created; a no-op when diagnostics are off.
+    static void label(GLenum identifier, GLuint name, const char* text) {
+        PFNGLOBJECTLABELPROC objectLabel = state().objectLabel;
+        if (objectLabel && name != 0) {
+            objectLabel(identifier, name, -1, text);
+        }
+    }
+
+    // Getters
+    static Mode getMode() { return state().mode; }
+
+private:
+    // Whether the context advertises an extension
+    static bool hasExtension(const char* name) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+            if (extension && std::strcmp(extension, name) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Prints the first occurrence of every distinct message
+    static void APIENTRY onMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+        const GLchar* message, const void* userParam) {
+        (void)userParam;
+        State& s = state();
+        std::string text = length >= 0 ? std::string(message, static_cast<size_t>(length)) : std::string(message);
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (++s.counts[MessageKey(id, text)] > 1) {
+                return;
+            }
+        }
+        std::cout << "GL " << severityName(severity) << " [" << sourceName(source) << ", " << typeName(type)
+            << ", id " << id << "]: " << text << std::endl;
+    }
+
+    static const char* sourceName(GLenum source) {
+        switch (source) {
+        case GL_DEBUG_SOURCE_API: return "API";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+        case GL_DEBUG_SOURCE_APPLICATION: return "application";
+        default: return "other";
+        }
+    }
+
+    static const char* typeName(GLenum type) {
+        switch (type) {
+        case GL_DEBUG_TYPE_ERROR: return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+        default: return "other";
+        }
+    }
+
+    static const char* severityName(GLenum severity) {
+        switch (severity) {
+        case GL_DEBUG_SEVERITY_HIGH: return "error";
+        case GL_DEBUG_SEVERITY_MEDIUM: return "warning";
+        case GL_DEBUG_SEVERITY_LOW: return "note";
+        default: return "info";
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef GL_HANDLE_H
+#define GL_HANDLE_H
+
+#include <glad/glad.h>
+#include <utility>
+
+// Creation and deletion functions for buffer objects
+struct GLBufferTraits {
+    static GLuint create() {
+        GLuint id = 0;
+        glGenBuffers(1, &id);
+        return id;
+    }
+    static void destroy(GLuint id) { glDeleteBuffers(1, &id); }
+};
+
+// Creation and deletion functions for vertex array objects
+struct GLVertexArrayTraits {
+    static GLuint create() {
+        GLuint id = 0;
+        glGenVertexArrays(1, &id);
+        return id;
+    }
+    static void destroy(GLuint id) { glDeleteVertexArrays(1, &id); }
+};
+
+// Creation and deletion functions for query objects
+struct GLQueryTraits {
+    static GLuint create() {
+        GLuint id = 0;
+        glGenQueries(1, &id);
+        return id;
+    }
+    static void destroy(GLuint id) { glDeleteQueries(1, &id); }
+};
+
+// Creation and deletion functions for texture objects
+struct GLTextureTraits {
+    static GLuint create() {
+        GLuint id = 0;
+        glGenTextures(1, &id);
+        return id;
+    }
+    static void destroy(GLuint id) { glDeleteTextures(1, &id); }
+};
+
+// Creation and deletion functions for framebuffer objects
+struct GLFramebufferTraits {
+    static GLuint create() {
+        GLuint id = 0;
+        glGenFramebuffers(1, &id);
+        return id;
+    }
+    static void destroy(GLuint id) { glDeleteFramebuffers(1, &id); }
+};
+
+// Move-only owner of a single OpenGL object name, deleted when the owner goes away.
+// Must be destroyed while the GL context that created it is still current.
+template <typename Traits>
+class GLHandle {
+private:
+    GLuint id; // OpenGL object name, 0 when empty
+
+public:
+    GLHandle() : id(0) {}
+    explicit GLHandle(GLuint id) : id(id) {}
+
+    ~GLHandle() {
+        reset();
+    }
+
+    GLHandle(const GLHandle&) = delete;
+    GLHandle& operator=(const GLHandle&) = delete;
+
+    GLHandle(GLHandle&& other) noexcept : id(other.id) {
+        other.id = 0;
+    }
+
+    GLHandle& operator=(GLHandle&& other) noexcept {
+        if (this != &other) {
+            reset();
+            id = other.id;
+            other.id = 0;
+        }
+        return *this;
+    }
+
+    // Creates a new object name
+    static GLHandle create() {
+        return GLHandle(Traits::create());
+    }
+
+    // Deletes the owned object, if any
+    void reset() {
+        if (id != 0) {
+            Traits::destroy(id);
+            id = 0;
+        }
+    }
+
+    // Getters
+    GLuint get() const { return id; }
+    explicit operator bool() const { return id != 0; }
+};
+
+using GLBuffer = GLHandle<GLBufferTraits>;
+using GLVertexArray = GLHandle<GLVertexArrayTraits>;
+using GLQuery = GLHandle<GLQueryTraits>;
+using GLTexture = GLHandle<GLTextureTraits>;
+using GLFramebuffer = GLHandle<GLFramebufferTraits>;
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef GLB_WRITER_H
+#define GLB_WRITER_H
+
+#include <glm/glm.hpp>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "mesh_data.h"
+#include "atomic_file.h"
+
+// Binary glTF 2.0 (GLB) exporter. Every mesh becomes one primitive of a single
+// glTF mesh with interleaved POSITION/NORMAL data and 32-bit indices. The JSON
+// chunk only needs sizes and position bounds, so it is built first and the
+// binary chunk then streams through fixed-size staging chunks with the
+// transform applied on the fly, keeping memory at a few MB.
+class GlbWriter {
+private:
+    // Vertices transformed per chunk, 1.5 MB of output
+    static constexpr size_t ChunkVertices = 1 << 16;
+
+    // glTF constants
+    static constexpr uint32_t Magic = 0x46546C67;           // "glTF"
+    static constexpr uint32_t Version = 2;
+    static constexpr uint32_t ChunkJson = 0x4E4F534A;       // "JSON"
+    static constexpr uint32_t ChunkBin = 0x004E4942;        // "BIN\0"
+    static constexpr int ArrayBuffer = 34962;               // Vertex buffer view target
+    static constexpr int ElementArrayBuffer = 34963;        // Index buffer view target
+    static constexpr int ComponentFloat = 5126;
+    static constexpr int ComponentUnsignedInt = 5125;
+    static constexpr int ModeTriangles = 4;
+
+    // Layout of one mesh within the binary chunk
+    struct Primitive {
+        const MeshData* mesh;
+        uint64_t vertexOffset;      // Byte offset of the interleaved vertices
+        uint64_t indexOffset;       // Byte offset of the indices
+        glm::vec3 min, max;         // Transformed position bounds, required by glTF
+    };
+
+public:
+    // Writes all meshes with the transform applied to positions and normals.
+    // Returns false if the file cannot be written, the old file then stays intact.
+    // Progress, if given, is the fraction of written elements.
+    static bool write(const std::string& path, const std::vector<MeshData>& meshes, const glm::mat4& transform,
+        std::atomic<float>* progress = nullptr) {
+        static_assert(sizeof(Vertex) == 6 * sizeof(float), "Vertex must be interleaved position and normal");
+        const glm::mat3 normalTransform = normalMatrix(transform);
+
+        // Lay out the binary chunk, the bounds pass only reads positions
+        std::vector<Primitive> primitives;
+        uint64_t binSize = 0;
+        size_t total = 0;
+        for (const auto& mesh : meshes) {
+            if (mesh.vertices.empty() || mesh.indices.size() < 3) {
+                continue;
+            }
+            Primitive primitive = { &mesh, binSize, binSize + mesh.vertices.size() * sizeof(Vertex),
+                glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()) };
+            for (const auto& vertex : mesh.vertices) {
+                glm::vec3 position = glm::vec3(transform * glm::vec4(vertex.Position, 1.0f));
+                primitive.min = glm::min(primitive.min, position);
+                primitive.max = glm::max(primitive.max, position);
+            }
+            binSize = primitive.indexOffset + mesh.indices.size() * sizeof(uint32_t);
+            total += mesh.vertices.size() + mesh.indices.size() / 3;
+            primitives.push_back(primitive);
+        }
+
+        std::string json = buildJson(primitives, binSize);
+        json.append((4 - json.size() % 4) % 4, ' ');
+        const uint64_t fileSize = 12 + 8 + json.size() + (binSize > 0 ? 8 + binSize : 0);
+        if (fileSize > std::numeric_limits<uint32_t>::max()) {
+            std::cout << "GLB export: model exceeds the 4 GB limit of the format" << std::endl;
+            return false;
+        }
+
+        // Header and JSON chunk; the host is little-endian like the format
+        AtomicFile::Writer file(path);
+        const uint32_t header[5] = { Magic, Version, static_cast<uint32_t>(fileSize),
+            static_cast<uint32_t>(json.size()), ChunkJson };
+        file.write(header, sizeof(header));
+        file.write(json.data(), json.size());
+
+        // Binary chunk, every section is a multiple of 4 bytes so no padding is needed
+        if (binSize > 0) {
+            const uint32_t binHeader[2] = { static_cast<uint32_t>(binSize), ChunkBin };
+            file.write(binHeader, sizeof(binHeader));
+        }
+        size_t written = 0;
+        std::vector<Vertex> vertexChunk(ChunkVertices);
+        for (const auto& primitive : primitives) {
+            const MeshData& mesh = *primitive.mesh;
+            for (size_t begin = 0; begin < mesh.vertices.size() && file.good(); begin += ChunkVertices) {
+                size_t count = std::min(ChunkVertices, mesh.vertices.size() - begin);
+                transformVertices(mesh.vertices.data() + begin, count, transform, normalTransform, vertexChunk.data());
+                file.write(vertexChunk.data(), count * sizeof(Vertex));
+                reportProgress(progress, written += count, total);
+            }
+            // Indices are relative to the primitive and need no conversion
+            file.write(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+            reportProgress(progress, written += mesh.indices.size() / 3, total);
+        }
+
+        if (!file.commit()) {
+            std::cout << "GLB export: cannot write " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    // Builds the glTF JSON describing the binary chunk layout
+    static std::string buildJson(const std::vector<Primitive>& primitives, uint64_t binSize) {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        writer.StartObject();
+        writer.Key("asset");
+        writer.StartObject();
+        writer.Key("version");
+        writer.String("2.0");
+        writer.Key("generator");
+        writer.String("HairOnBaldModel");
+        writer.EndObject();
+        writer.Key("scene");
+        writer.Int(0);
+        writer.Key("scenes");
+        writer.StartArray();
+        writer.StartObject();
+        writer.Key("nodes");
+        writer.StartArray();
+        writer.Int(0);
+        writer.EndArray();
+        writer.EndObject();
+        writer.EndArray();
+        writer.Key("nodes");
+        writer.StartArray();
+        writer.StartObject();
+        if (!primitives.empty()) {
+            writer.Key("mesh");
+            writer.Int(0);
+        }
+        writer.EndObject();
+        writer.EndArray();
+
+        if (!primitives.empty()) {
+            writer.Key("meshes");
+            writer.StartArray();
+            writer.StartObject();
+            writer.Key("primitives");
+            writer.StartArray();
+            for (size_t i = 0; i < primitives.size(); i++) {
+                unsigned int accessor = static_cast<unsigned int>(i * 3);
+                writer.StartObject();
+                writer.Key("attributes");
+                writer.StartObject();
+                writer.Key("POSITION");
+                writer.Uint(accessor);
+                writer.Key("NORMAL");
+                writer.Uint(accessor + 1);
+                writer.EndObject();
+                writer.Key("indices");
+                writer.Uint(accessor + 2);
+                writer.Key("mode");
+                writer.Int(ModeTriangles);
+                writer.EndObject();
+            }
+            writer.EndArray();
+            writer.EndObject();
+            writer.EndArray();
+
+            // Accessors per primitive: position, normal, indices
+            writer.Key("accessors");
+            writer.StartArray();
+            for (size_t i = 0; i < primitives.size(); i++) {
+                const Primitive& primitive = primitives[i];
+                unsigned int view = static_cast<unsigned int>(i * 2);
+                uint64_t vertexCount = primitive.mesh->vertices.size();
+                writeAccessor(writer, view, offsetof(Vertex, Position), ComponentFloat, vertexCount, "VEC3",
+                    &primitive.min, &primitive.max);
+                writeAccessor(writer, view, offsetof(Vertex, Normal), ComponentFloat, vertexCount, "VEC3",
+                    nullptr, nullptr);
+                writeAccessor(writer, view + 1, 0, ComponentUnsignedInt, primitive.mesh->indices.size(), "SCALAR",
+                    nullptr, nullptr);
+            }
+            writer.EndArray();
+
+            // Buffer views per primitive: interleaved vertices, indices
+            writer.Key("bufferViews");
+            writer.StartArray();
+            for (const auto& primitive : primitives) {
+                writer.StartObject();
+                writer.Key("buffer");
+                writer.Int(0);
+                writer.Key("byteOffset");
+                writer.Uint64(primitive.vertexOffset);
+                writer.Key("byteLength");
+                writer.Uint64(primitive.indexOffset - primitive.vertexOffset);
+                writer.Key("byteStride");
+                writer.Uint(static_cast<unsigned int>(sizeof(Vertex)));
+                writer.Key("target");
+                writer.Int(ArrayBuffer);
+                writer.EndObject();
+                writer.StartObject();
+                writer.Key("buffer");
+                writer.Int(0);
+                writer.Key("byteOffset");
+                writer.Uint64(primitive.indexOffset);
+                writer.Key("byteLength");
+                writer.Uint64(primitive.mesh->indices.size() * sizeof(uint32_t));
+                writer.Key("target");
+                writer.Int(ElementArrayBuffer);
+                writer.EndObject();
+            }
+            writer.EndArray();
+
+            writer.Key("buffers");
+            writer.StartArray();
+            writer.StartObject();
+            writer.Key("byteLength");
+            writer.Uint64(binSize);
+            writer.EndObject();
+            writer.EndArray();
+        }
+        writer.EndObject();
+        return std::string(buffer.GetString(), buffer.GetSize());
+    }
+
+    // Writes one accessor, min and max are only given for positions
+    static void writeAccessor(rapidjson::Writer<rapidjson::StringBuffer>& writer, unsigned int bufferView,
+        size_t byteOffset, int componentType, uint64_t count, const char* type,
+        const glm::vec3* min, const glm::vec3* max) {
+        writer.StartObject();
+        writer.Key("bufferView");
+        writer.Uint(bufferView);
+        writer.Key("byteOffset");
+        writer.Uint64(byteOffset);
+        writer.Key("componentType");
+        writer.Int(componentType);
+        writer.Key("count");
+        writer.Uint64(count);
+        writer.Key("type");
+        writer.String(type);
+        if (min && max) {
+            writer.Key("min");
+            writeVec3(writer, *min);
+            writer.Key("max");
+            writeVec3(writer, *max);
+        }
+        writer.EndObject();
+    }
+
+    static void writeVec3(rapidjson::Writer<rapidjson::StringBuffer>& writer, const glm::vec3& value) {
+        writer.StartArray();
+        for (int k = 0; k < 3; k++) {
+            writer.Double(value[k]);
+        }
+        writer.EndArray();
+    }
+
+    static void reportProgress(std::atomic<float>* progress, size_t written, size_t total) {
+        if (progress) {
+            *progress = static_cast<float>(written) / static_cast<float>(std::max<size_t>(1, total));
+        }
+    }
+};
+
+#endif
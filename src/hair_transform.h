@@ -91,14 +91,26 @@ public:
 
     // Get model matrix combining all transformations
     glm::mat4 getModelMatrix() const {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, position);
-        model = glm::rotate(model, glm::radians(rotationY), glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::rotate(model, glm::radians(rotationX), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = glm::rotate(model, glm::radians(rotationZ), glm::vec3(0.0f, 0.0f, 1.0f));
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), position) * getRotationMatrix();
         model = glm::scale(model, glm::vec3(scaleValue));
         return model;
     }
+
+    // Get normal matrix of the model matrix. Rotation R with uniform scale s has
+    // the inverse transpose R / s, so no matrix inverse is needed.
+    glm::mat3 getNormalMatrix() const {
+        glm::mat3 rotation = glm::mat3(getRotationMatrix());
+        return scaleValue != 0.0f ? rotation / scaleValue : rotation;
+    }
+
+private:
+    // Yaw, pitch and roll combined, in that order
+    glm::mat4 getRotationMatrix() const {
+        glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::radians(rotationY), glm::vec3(0.0f, 1.0f, 0.0f));
+        rotation = glm::rotate(rotation, glm::radians(rotationX), glm::vec3(1.0f, 0.0f, 0.0f));
+        rotation = glm::rotate(rotation, glm::radians(rotationZ), glm::vec3(0.0f, 0.0f, 1.0f));
+        return rotation;
+    }
 };
 
 #endif
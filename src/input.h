@@ -8,6 +8,7 @@
 #include "hair_transform.h" 
 #include "model.h"     
 #include "ImGuiFileDialog.h"
+#include "profiler.h"
 #include <imgui.h>
 
 class InputManager {
@@ -20,13 +21,14 @@ private:
     bool* renderBald;           // Pointer to render bald mode toggle
     bool* renderHair;           // Pointer to render hair mode toggle
     bool* mouseLocked;          // Pointer to mouse lock status
+    bool* overdrawMode;         // Pointer to overdraw heat map toggle
     float lastKeyPressTime;     // Time tracking to prevent key spamming
     const float keyCooldown = 0.2f;  // Key cooldown time to prevent accidental multiple key presses
 
 public:
     // Constructor to initialize InputManager with window, camera, and other required parameters
     InputManager(GLFWwindow* window, Camera* camera, HairTransform* hairTransform,
-        bool* wireframeMode, bool* renderBald, bool* renderHair, bool* mouseLocked) :
+        bool* wireframeMode, bool* renderBald, bool* renderHair, bool* mouseLocked, bool* overdrawMode) :
         window(window),
         camera(camera),
         hairTransform(hairTransform),
@@ -34,6 +36,7 @@ public:
         renderBald(renderBald),
         renderHair(renderHair),
         mouseLocked(mouseLocked),
+        overdrawMode(overdrawMode),
         lastKeyPressTime(0.0f) {
     }
 
@@ -45,6 +48,7 @@ public:
 
     // Input processing in the main loop
     void processInput(float deltaTime) {
+        PROFILE_SCOPE("InputManager::processInput");
         float currentTime = static_cast<float>(glfwGetTime()); // Get the current time to track key press timings
 
         // Check if the escape key is pressed to close the window
@@ -68,6 +72,13 @@ public:
             lastKeyPressTime = currentTime;
         }
 
+        // Toggle the overdraw heat map using the 'H' key
+        if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS && currentTime - lastKeyPressTime > keyCooldown) {
+            *overdrawMode = !(*overdrawMode);
+            std::cout << "Overdraw heat map " << (*overdrawMode ? "on" : "off") << std::endl;
+            lastKeyPressTime = currentTime;
+        }
+
         // Toggle rendering modes (bald, hair, both) with keys 1, 2, and 3
         if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS && currentTime - lastKeyPressTime > keyCooldown) {
             *renderBald = true;
@@ -107,11 +118,17 @@ public:
             if (!io.WantCaptureKeyboard) {
                 IGFD::FileDialogConfig config;
                 config.path = "models/";
-                ImGuiFileDialog::Instance()->OpenDialog("ChooseHairDlgKey", "Select Hair Model", ".obj,.ply", config);
+                ImGuiFileDialog::Instance()->OpenDialog("ChooseHairDlgKey", "Select Hair Model", ".obj,.ply,.glb,.drc", config);
                 lastKeyPressTime = currentTime;
             }
         }
 
+        // Write the recent profiler history to a trace file with the 'F9' key
+        if (glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS && currentTime - lastKeyPressTime > keyCooldown) {
+            Profiler::writeTrace(profilerTracePath());
+            lastKeyPressTime = currentTime;
+        }
+
         // Adjust hair position using I, J, K, L keys (works regardless of mouse lock or ImGui focus)
         if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS)
             hairTransform->adjustPosition(0.0f, 1.0f, 0.0f, deltaTime); // Move up
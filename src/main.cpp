@@ -3,27 +3,59 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <fstream>
 #include <filesystem>
+#include <vector>
 
 #include "shader.h"
+#include "frame_uniforms.h"
+#include "gl_diagnostics.h"
+#include "perf_stats.h"
+#include "overdraw_view.h"
+#include "profiler.h"
+#include "redraw_scheduler.h"
 #include "model.h"
 #include "camera.h"
 #include "hair_transform.h"
 #include "ui.h"
 #include "input.h"
+#include "model_loader.h"
+#include "model_saver.h"
+#include "placement.h"
+#include "batch_runner.h"
 
 #include <imgui.h>
 
-// Function to check for OpenGL errors at a specific location
-static void checkGLError(const std::string& location) {
-    GLenum err;
-    while ((err = glGetError()) != GL_NO_ERROR) {
-        std::cout << "OpenGL Error at " << location << ": " << err << std::endl;
+// Initial window size
+static const unsigned int SCR_WIDTH = 1280;
+static const unsigned int SCR_HEIGHT = 720;
+
+// Everything outside the UI that changes the rendered image, compared between
+// frames to notice changes made without window events
+struct SceneState {
+    glm::mat4 view;
+    glm::mat4 hairModel;
+    glm::vec3 hairColor;
+    float fov;
+    bool wireframe;
+    bool renderBald;
+    bool renderHair;
+    bool compactVertices;
+    bool cullOpenBackFaces;
+    bool depthPrepass;
+
+    bool operator==(const SceneState& other) const {
+        return view == other.view && hairModel == other.hairModel && hairColor == other.hairColor &&
+            fov == other.fov && wireframe == other.wireframe && renderBald == other.renderBald &&
+            renderHair == other.renderHair && compactVertices == other.compactVertices &&
+            cullOpenBackFaces == other.cullOpenBackFaces && depthPrepass == other.depthPrepass;
     }
-}
+    bool operator!=(const SceneState& other) const { return !(*this == other); }
+};
 
 // Function to verify if a file exists on disk
 static bool checkFileExists(const std::string& path) {
@@ -35,71 +67,25 @@ static bool checkFileExists(const std::string& path) {
     return exists;
 }
 
-int main() {
-    std::cout << "Current working directory: " << std::filesystem::current_path().string() << std::endl;
-
-    // Initialize GLFW
-    if (!glfwInit()) {
-        std::cout << "Failed to initialize GLFW" << std::endl;
-        return -1;
-    }
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    // Create a window
-    const unsigned int SCR_WIDTH = 1280;
-    const unsigned int SCR_HEIGHT = 720;
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "HairOnBald", nullptr, nullptr);
-    if (window == nullptr) {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
-    glfwMakeContextCurrent(window);
-
-    // Initialize GLAD (load OpenGL function pointers)
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        glfwDestroyWindow(window);
-        glfwTerminate();
-        return -1;
-    }
-    checkGLError("GLAD initialization");
-
-    // Print OpenGL and GLSL version information
-    const GLubyte* glVersion = glGetString(GL_VERSION);
-    const GLubyte* glslVersion = glGetString(GL_SHADING_LANGUAGE_VERSION);
-    if (glVersion == nullptr || glslVersion == nullptr) {
-        std::cout << "Failed to retrieve OpenGL or GLSL version" << std::endl;
-        glfwDestroyWindow(window);
-        glfwTerminate();
-        return -1;
-    }
-    std::cout << "OpenGL Version: " << glVersion << std::endl;
-    std::cout << "GLSL Version: " << glslVersion << std::endl;
-
+// Sets up GL state, resources and UI and runs the render loop. Everything created
+// here owns GPU objects, so it is destroyed before the context goes away.
+static int run(GLFWwindow* window) {
     // Basic OpenGL setup
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LESS);
     glDisable(GL_CULL_FACE);
     glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
-    checkGLError("OpenGL setup");
 
     // Load and compile shaders
     std::string vertexPath = "shaders/vertex.glsl";
     std::string fragmentPath = "shaders/fragment.glsl";
     if (!checkFileExists(vertexPath) || !checkFileExists(fragmentPath)) {
         std::cout << "Shader file missing" << std::endl;
-        glfwDestroyWindow(window);
-        glfwTerminate();
         return -1;
     }
     Shader shader(vertexPath.c_str(), fragmentPath.c_str());
     if (shader.ID == 0) {
         std::cout << "Shader program failed to load or link" << std::endl;
-        glfwDestroyWindow(window);
-        glfwTerminate();
         return -1;
     }
     GLint success;
@@ -108,56 +94,118 @@ int main() {
         char infoLog[1024];
         glGetProgramInfoLog(shader.ID, 1024, nullptr, infoLog);
         std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-        glfwDestroyWindow(window);
-        glfwTerminate();
         return -1;
     }
+    GLDiagnostics::label(GL_PROGRAM, shader.ID, "Model shader");
+
+    // Depth-only program for the optional pre-pass; it shares the vertex shader,
+    // whose invariant position makes its depth match the shading pass exactly
+    std::string depthFragmentPath = "shaders/depth_fragment.glsl";
+    if (!checkFileExists(depthFragmentPath)) {
+        std::cout << "Shader file missing" << std::endl;
+        return -1;
+    }
+    Shader depthShader(vertexPath.c_str(), depthFragmentPath.c_str());
+    if (depthShader.ID == 0) {
+        std::cout << "Depth shader program failed to load or link" << std::endl;
+        return -1;
+    }
+    GLDiagnostics::label(GL_PROGRAM, depthShader.ID, "Depth pre-pass shader");
+
+    // Camera and light uniforms, uploaded once per frame
+    FrameUniforms frameUniforms;
+    frameUniforms.attach(shader);
+    frameUniforms.attach(depthShader);
+
+    // Overdraw heat map: counts fragments per pixel with the model vertex shader
+    // and shows them with a fullscreen pass
+    std::string overdrawFragmentPath = "shaders/overdraw_fragment.glsl";
+    std::string fullscreenVertexPath = "shaders/fullscreen_vertex.glsl";
+    std::string heatmapFragmentPath = "shaders/heatmap_fragment.glsl";
+    if (!checkFileExists(overdrawFragmentPath) || !checkFileExists(fullscreenVertexPath) ||
+        !checkFileExists(heatmapFragmentPath)) {
+        std::cout << "Shader file missing" << std::endl;
+        return -1;
+    }
+    OverdrawView overdrawView(vertexPath.c_str(), overdrawFragmentPath.c_str(), fullscreenVertexPath.c_str(),
+        heatmapFragmentPath.c_str());
+    frameUniforms.attach(overdrawView.getCountShader());
+
+    // Shared GPU storage for all meshes, declared before the models so it outlives them
+    MeshArena meshArena;
 
     // Load 3D models
     std::string baldHeadPath = "models/bald_head.obj";
     if (!checkFileExists(baldHeadPath)) {
-        glfwDestroyWindow(window);
-        glfwTerminate();
         return -1;
     }
-    Model baldHead(baldHeadPath.c_str());
+    Model baldHead(baldHeadPath.c_str(), meshArena);
 
+    // Without the default hair start empty, another one can be picked in the UI
     std::string initialHairPath = "models/hair_front.obj";
-    if (!checkFileExists(initialHairPath)) {
-        glfwDestroyWindow(window);
-        glfwTerminate();
-        return -1;
-    }
-    Model hair(initialHairPath.c_str());
+    Model hair = checkFileExists(initialHairPath)
+        ? Model(initialHairPath, meshArena)
+        : Model(std::vector<MeshData>(), meshArena);
 
     // Camera setup
     Camera camera(glm::vec3(0.0f, 0.5f, 5.0f));
 
     // Hair transformation setup
+    // An empty hair has no file, so nothing can be placed, baked or exported against it
     HairTransform hairTransform;
-    hairTransform.setModelPath(initialHairPath);
+    hairTransform.setModelPath(hair.getMeshData()->empty() ? std::string() : initialHairPath);
 
     // UI and rendering options
     bool wireframe = false;
     bool renderBald = true;
     bool renderHair = true;
     bool mouseLocked = true;
+    bool compactVertices = false;
+    bool overdrawMode = false;
+    VertexFormat vertexFormat = VertexFormat::Float;
+
+    // Background loader for hair models picked in the UI
+    ModelLoader hairLoader;
+
+    // Background saver, finishes any queued save before run() returns
+    ModelSaver hairSaver;
+
+    // Threads culling meshlets each frame
+    WorkerPool cullWorkers;
 
     // UI initialization
-    UI ui(&wireframe, &renderBald, &renderHair, &mouseLocked, &hairTransform, &hair);
+    UI ui(&wireframe, &renderBald, &renderHair, &mouseLocked, &compactVertices, &hairTransform, &hair, &hairLoader, &hairSaver);
     ui.initialize(window);
+    ui.setHeadPath(baldHeadPath);
+
+    // Frame timings and draw counts for the performance overlay
+    PerfStats perfStats;
+    ui.setPerfStats(&perfStats);
+    ui.setOverdrawView(&overdrawView, &overdrawMode);
 
     // Input manager setup
-    InputManager inputManager(window, &camera, &hairTransform, &wireframe, &renderBald, &renderHair, &mouseLocked);
+    InputManager inputManager(window, &camera, &hairTransform, &wireframe, &renderBald, &renderHair, &mouseLocked,
+        &overdrawMode);
     inputManager.setupCallbacks();
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
+    // Renders only while something changes, installed after the ImGui and input
+    // callbacks it forwards to
+    RedrawScheduler redraw;
+    redraw.install(window);
+    SceneState lastScene{};
+
     // Position and scale initialization
     auto baldBox = baldHead.getBoundingBox();
     auto hairBox = hair.getBoundingBox();
     float targetScale = 1.0f;
     hairTransform.reset(targetScale);
     hairTransform.setPosition(glm::vec3(0.0f, 0.0f, 0.0f));
+    // Pick up where the last session left off if the hair has a saved placement
+    if (!hairTransform.getModelPath().empty() &&
+        Placement::restore(initialHairPath, hair.getContentHash(), hairTransform)) {
+        std::cout << "Restored placement from " << Placement::sidecarPath(initialHairPath) << std::endl;
+    }
 
     std::cout << "Bald Box: min(" << baldBox.min.x << ", " << baldBox.min.y << ", " << baldBox.min.z << "), max("
         << baldBox.max.x << ", " << baldBox.max.y << ", " << baldBox.max.z << ")\n";
@@ -176,32 +224,74 @@ int main() {
 
     // --- Main Rendering Loop ---
     while (!glfwWindowShouldClose(window)) {
+        PROFILE_SCOPE("Frame");
+
         // Calculate frame time
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
+        perfStats.beginFrame(meshArena);
+
+        // Swap in a finished hair load at the frame boundary
+        if (ui.applyLoadedModel()) {
+            redraw.invalidate();
+        }
+
+        // Re-upload both models when the vertex format was toggled
+        VertexFormat requestedFormat = compactVertices ? VertexFormat::Compact : VertexFormat::Float;
+        if (requestedFormat != vertexFormat) {
+            baldHead.setVertexFormat(requestedFormat);
+            hair.setVertexFormat(requestedFormat);
+            vertexFormat = requestedFormat;
+        }
 
         // Handle user input
-        inputManager.processInput(deltaTime);
-
-        // Start new ImGui frame
-        ui.newFrame();
-        ImGuiIO& io = ImGui::GetIO();
-
-        // Mouse movement and scroll handling (if mouse is locked)
-        if (mouseLocked) {
-            float xoffset = io.MouseDelta.x;
-            float yoffset = -io.MouseDelta.y;
-            if (xoffset != 0.0f || yoffset != 0.0f) {
-                camera.processMouseMovement(xoffset, yoffset);
-            }
-            if (io.MouseWheel != 0.0f) {
-                camera.processMouseScroll(io.MouseWheel);
+        {
+            PerfStats::CpuScope timer(perfStats, PerfStats::Cpu::Input);
+            inputManager.processInput(deltaTime);
+        }
+
+        {
+            PerfStats::CpuScope timer(perfStats, PerfStats::Cpu::UiBuild);
+
+            // Start new ImGui frame
+            ui.newFrame();
+            ImGuiIO& io = ImGui::GetIO();
+
+            // Mouse movement and scroll handling (if mouse is locked)
+            if (mouseLocked) {
+                float xoffset = io.MouseDelta.x;
+                float yoffset = -io.MouseDelta.y;
+                if (xoffset != 0.0f || yoffset != 0.0f) {
+                    camera.processMouseMovement(xoffset, yoffset);
+                }
+                if (io.MouseWheel != 0.0f) {
+                    camera.processMouseScroll(io.MouseWheel);
+                }
             }
+
+            // Render ImGui controls
+            ui.renderUI(deltaTime);
         }
 
-        // Render ImGui controls
-        ui.renderUI(deltaTime);
+        // Keep rendering after changes made by code rather than window events
+        SceneState scene{ camera.getViewMatrix(), hairTransform.getModelMatrix(), hairTransform.getColor(),
+            camera.getFov(), wireframe, renderBald, renderHair, compactVertices, ui.getCullOpenBackFaces(),
+            ui.getDepthPrepass() };
+        if (scene != lastScene) {
+            redraw.invalidate();
+            lastScene = scene;
+        }
+        // Text fields blink their cursor and active widgets may change without input
+        if (ImGui::IsAnyItemActive() || ImGui::GetIO().WantTextInput) {
+            redraw.invalidate(1);
+        }
+        // Depth complexity metrics arrive a few frames after the counts were drawn
+        if (overdrawMode && overdrawView.isReadbackPending()) {
+            redraw.invalidate(1);
+        }
+        redraw.setContinuous(ui.isPerformanceOverlayShown());
+        redraw.setBusy(ui.isBusy());
 
         // Clear frame buffers
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
@@ -211,41 +301,232 @@ int main() {
         shader.use();
         glm::mat4 projection = glm::perspective(glm::radians(camera.getFov()), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
         glm::mat4 view = camera.getViewMatrix();
-        shader.setMat4("projection", projection);
-        shader.setMat4("view", view);
-        shader.setVec3("lightPos", lightPos);
-        shader.setVec3("viewPos", camera.getPosition());
-        shader.setVec3("lightColor", lightColor);
-
-        // Draw bald head model
-        if (renderBald) {
-            glm::mat4 baldModel = glm::mat4(1.0f);
-            baldModel = glm::translate(baldModel, glm::vec3(0.0f, 0.0f, 0.0f));
-            baldModel = glm::scale(baldModel, glm::vec3(targetScale));
-            shader.setMat4("model", baldModel);
-            shader.setVec3("objectColor", glm::vec3(1.0f, 0.9f, 0.7f));
-            baldHead.Draw(shader);
-            checkGLError("Bald head render");
-        }
-
-        // Draw hair model
-        if (renderHair) {
-            glm::mat4 hairModelMatrix = hairTransform.getModelMatrix();
-            shader.setMat4("model", hairModelMatrix);
-            shader.setVec3("objectColor", hairTransform.getColor());
-            hair.Draw(shader);
-            checkGLError("Hair render");
+        FrameData frameData;
+        frameData.projection = projection;
+        frameData.view = view;
+        frameData.lightPos = glm::vec4(lightPos, 1.0f);
+        frameData.viewPos = glm::vec4(camera.getPosition(), 1.0f);
+        frameData.lightColor = glm::vec4(lightColor, 1.0f);
+        frameUniforms.update(frameData);
+        LodView lodView;
+        lodView.viewProjection = projection * view;
+        lodView.cameraPosition = camera.getPosition();
+        lodView.fov = camera.getFov();
+        lodView.viewportHeight = static_cast<float>(SCR_HEIGHT);
+        // Wireframe shows back faces through the front, keep them
+        lodView.backFaceCulling = !wireframe;
+        lodView.openMeshBackFaces = ui.getCullOpenBackFaces();
+        lodView.workers = &cullWorkers;
+
+        glm::mat4 baldModel = glm::mat4(1.0f);
+        baldModel = glm::translate(baldModel, glm::vec3(0.0f, 0.0f, 0.0f));
+        baldModel = glm::scale(baldModel, glm::vec3(targetScale));
+        glm::mat4 hairModelMatrix = hairTransform.getModelMatrix();
+
+        // Overdraw heat map: count the fragments of each model instead of shading them
+        int framebufferWidth = 0, framebufferHeight = 0;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        if (overdrawMode && overdrawView.begin(framebufferWidth, framebufferHeight)) {
+            if (renderBald) {
+                Shader& countShader = overdrawView.countLayer(OverdrawView::Layer::Head);
+                countShader.setMat4("model", baldModel);
+                lodView.model = baldModel;
+                baldHead.Draw(countShader, lodView);
+            }
+            if (renderHair) {
+                Shader& countShader = overdrawView.countLayer(OverdrawView::Layer::Hair);
+                countShader.setMat4("model", hairModelMatrix);
+                lodView.model = hairModelMatrix;
+                hair.Draw(countShader, lodView);
+            }
+            overdrawView.end();
+        }
+        else {
+            // Depth pre-pass: lay down the depth of both models with colour writes off,
+            // so the shading pass below runs the fragment shader once per pixel. The
+            // shading pass resubmits the culled batches of this pass with GL_EQUAL.
+            const bool depthPrepass = ui.getDepthPrepass();
+            if (depthPrepass) {
+                PerfStats::GpuScope timer(perfStats, PerfStats::Gpu::DepthPrepass);
+                depthShader.use();
+                glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+                if (renderBald) {
+                    depthShader.setMat4("model", baldModel);
+                    lodView.model = baldModel;
+                    baldHead.Draw(depthShader, lodView);
+                }
+                if (renderHair) {
+                    depthShader.setMat4("model", hairModelMatrix);
+                    lodView.model = hairModelMatrix;
+                    hair.Draw(depthShader, lodView);
+                }
+                glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+                glDepthFunc(GL_EQUAL);
+                glDepthMask(GL_FALSE);
+                shader.use();
+            }
+
+            {
+                // Fragments shaded by both models, the overdraw the pre-pass removes
+                PerfStats::SampleScope samples(perfStats);
+
+                // Draw bald head model
+                if (renderBald) {
+                    PerfStats::GpuScope timer(perfStats, PerfStats::Gpu::BaldHead);
+                    shader.setMat4("model", baldModel);
+                    shader.setMat3("normalMatrix", normalMatrix(baldModel));
+                    shader.setVec3("objectColor", glm::vec3(1.0f, 0.9f, 0.7f));
+                    if (depthPrepass) {
+                        baldHead.redraw(shader);
+                    }
+                    else {
+                        lodView.model = baldModel;
+                        baldHead.Draw(shader, lodView);
+                    }
+                }
+
+                // Draw hair model
+                if (renderHair) {
+                    PerfStats::GpuScope timer(perfStats, PerfStats::Gpu::Hair);
+                    shader.setMat4("model", hairModelMatrix);
+                    shader.setMat3("normalMatrix", hairTransform.getNormalMatrix());
+                    shader.setVec3("objectColor", hairTransform.getColor());
+                    if (depthPrepass) {
+                        hair.redraw(shader);
+                    }
+                    else {
+                        lodView.model = hairModelMatrix;
+                        hair.Draw(shader, lodView);
+                    }
+                }
+            }
+            if (depthPrepass) {
+                glDepthFunc(GL_LESS);
+                glDepthMask(GL_TRUE);
+            }
         }
 
         // Finalize ImGui and swap buffers
-        ui.renderEndFrame();
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            PerfStats::GpuScope timer(perfStats, PerfStats::Gpu::Ui);
+            ui.renderEndFrame();
+        }
+        {
+            PerfStats::CpuScope timer(perfStats, PerfStats::Cpu::Swap);
+            glfwSwapBuffers(window);
+        }
+        redraw.frameRendered();
+
+        // Block until the next change, the last frame stays on screen meanwhile
+        if (redraw.waitForFrame(window)) {
+            lastFrame = static_cast<float>(glfwGetTime());
+            perfStats.skipFrame();
+        }
     }
 
     // Cleanup resources
     ui.cleanup();
+    return 0;
+}
+
+// Prints command line usage
+static void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--gl-debug off|callback|sync] [--trace <file>]              interactive viewer\n"
+        << "       " << program << " --batch <jobs.json> [--threads N] [--cache] [--trace <file>]  headless export\n"
+        << "--cache also stores the batch's models in the mesh cache\n"
+        << "--trace writes a profiler trace on exit, F9 writes one at any time in the viewer" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Current working directory: " << std::filesystem::current_path().string() << std::endl;
+
+    PROFILE_THREAD_NAME("Main");
+
+    std::string jobFile;
+    std::string traceFile;
+    unsigned int threads = 0;
+    bool storeInCache = false;
+    GLDiagnostics::Mode diagnostics = GLDiagnostics::defaultMode();
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--batch" && i + 1 < argc) {
+            jobFile = argv[++i];
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned int>(std::max(0, std::atoi(argv[++i])));
+        }
+        else if (arg == "--cache") {
+            storeInCache = true;
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        }
+        else if (arg == "--gl-debug" && i + 1 < argc && GLDiagnostics::parseMode(argv[i + 1], diagnostics)) {
+            i++;
+        }
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Batch mode runs without a window or GL context
+    if (!jobFile.empty()) {
+        int result = BatchRunner::run(jobFile, threads, storeInCache);
+        if (!traceFile.empty()) {
+            Profiler::writeTrace(traceFile);
+        }
+        return result;
+    }
+
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cout << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // Debug contexts make the driver validate and report, only ask when diagnostics are on
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, diagnostics != GLDiagnostics::Mode::Off ? GLFW_TRUE : GLFW_FALSE);
+
+    // Create a window
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "HairOnBald", nullptr, nullptr);
+    if (window == nullptr) {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    // Initialize GLAD (load OpenGL function pointers)
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return -1;
+    }
+    GLDiagnostics::initialize(diagnostics, (GLADloadproc)glfwGetProcAddress);
+
+    // Print OpenGL and GLSL version information
+    const GLubyte* glVersion = glGetString(GL_VERSION);
+    const GLubyte* glslVersion = glGetString(GL_SHADING_LANGUAGE_VERSION);
+    if (glVersion == nullptr || glslVersion == nullptr) {
+        std::cout << "Failed to retrieve OpenGL or GLSL version" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return -1;
+    }
+    std::cout << "OpenGL Version: " << glVersion << std::endl;
+    std::cout << "GLSL Version: " << glslVersion << std::endl;
+
+    int result = run(window);
+    GLDiagnostics::shutdown();
+    if (!traceFile.empty()) {
+        Profiler::writeTrace(traceFile);
+    }
+
     glfwDestroyWindow(window);
     glfwTerminate();
-    return 0;
+    return result;
 }
@@ -0,0 +1,123 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole file, released on destruction
+class MappedFile {
+private:
+    const unsigned char* bytes; // Start of the mapped view
+    size_t length;              // Size of the mapped view in bytes
+#ifdef _WIN32
+    HANDLE fileHandle;          // Handle of the opened file
+    HANDLE mappingHandle;       // Handle of the file mapping object
+#else
+    int fileDescriptor;         // Descriptor of the opened file
+#endif
+
+public:
+    MappedFile()
+        : bytes(nullptr),
+        length(0),
+#ifdef _WIN32
+        fileHandle(INVALID_HANDLE_VALUE),
+        mappingHandle(nullptr) {
+#else
+        fileDescriptor(-1) {
+#endif
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps the file at path, returns false if it cannot be opened or is empty
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+            close();
+            return false;
+        }
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr) {
+            close();
+            return false;
+        }
+        bytes = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (bytes == nullptr) {
+            close();
+            return false;
+        }
+        length = static_cast<size_t>(fileSize.QuadPart);
+#else
+        fileDescriptor = ::open(path.c_str(), O_RDONLY);
+        if (fileDescriptor < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fileDescriptor, &info) != 0 || info.st_size == 0) {
+            close();
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (view == MAP_FAILED) {
+            close();
+            return false;
+        }
+        madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+        bytes = static_cast<const unsigned char*>(view);
+        length = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    // Unmaps the view and closes the file
+    void close() {
+#ifdef _WIN32
+        if (bytes) UnmapViewOfFile(bytes);
+        if (mappingHandle) CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (bytes) munmap(const_cast<unsigned char*>(bytes), length);
+        if (fileDescriptor >= 0) ::close(fileDescriptor);
+        fileDescriptor = -1;
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    // Getters
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool isOpen() const { return bytes != nullptr; }
+};
+
+#endif
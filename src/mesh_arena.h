@@ -0,0 +1,354 @@
+#ifndef MESH_ARENA_H
+#define MESH_ARENA_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "gl_handle.h"
+#include "gl_diagnostics.h"
+#include "mesh_data.h"
+#include "vertex_format.h"
+
+// Draw commands collected for one glMultiDrawElementsBaseVertex call
+struct DrawBatch {
+    std::vector<GLsizei> counts;       // Index count per draw
+    std::vector<const void*> offsets;  // Byte offset into the element buffer per draw
+    std::vector<GLint> baseVertices;   // Added to every index of the draw
+
+    // Empties the batch, keeping its storage for the next frame
+    void clear() {
+        counts.clear();
+        offsets.clear();
+        baseVertices.clear();
+    }
+
+    // Appends the draws of another batch
+    void append(const DrawBatch& other) {
+        counts.insert(counts.end(), other.counts.begin(), other.counts.end());
+        offsets.insert(offsets.end(), other.offsets.begin(), other.offsets.end());
+        baseVertices.insert(baseVertices.end(), other.baseVertices.begin(), other.baseVertices.end());
+    }
+};
+
+// Shared GPU storage for all meshes: one vertex buffer, one element buffer and
+// one VAO per vertex format. Meshes suballocate ranges and are drawn through
+// base vertices and element offsets, so a whole model is a single submission.
+// Freed ranges are reclaimed by compact(). Must be destroyed after every model
+// using it and while the GL context is still current.
+class MeshArena {
+public:
+    // Move-only owner of one suballocation, frees its ranges when it goes away
+    class Allocation {
+    private:
+        MeshArena* arena; // Owning arena, null when empty
+        uint32_t id;      // Slot in the arena's handle table
+
+    public:
+        Allocation() : arena(nullptr), id(0) {}
+        Allocation(MeshArena* arena, uint32_t id) : arena(arena), id(id) {}
+
+        ~Allocation() {
+            reset();
+        }
+
+        Allocation(const Allocation&) = delete;
+        Allocation& operator=(const Allocation&) = delete;
+
+        Allocation(Allocation&& other) noexcept : arena(other.arena), id(other.id) {
+            other.arena = nullptr;
+        }
+
+        Allocation& operator=(Allocation&& other) noexcept {
+            if (this != &other) {
+                reset();
+                arena = other.arena;
+                id = other.id;
+                other.arena = nullptr;
+            }
+            return *this;
+        }
+
+        // Returns the ranges to the arena
+        void reset() {
+            if (arena) {
+                arena->release(id);
+                arena = nullptr;
+            }
+        }
+
+        // Getters
+        uint32_t getId() const { return id; }
+        explicit operator bool() const { return arena != nullptr; }
+    };
+
+    // Submissions counted by draw() until takeDrawStats()
+    struct DrawStats {
+        unsigned int drawCalls = 0;     // GL draw calls
+        unsigned int meshDraws = 0;     // Index ranges drawn by those calls
+        uint64_t triangles = 0;         // Triangles submitted
+        unsigned int culledMeshes = 0;  // Meshes skipped as outside the view frustum
+        unsigned int culledMeshlets = 0; // Meshlets of drawn meshes skipped as off-screen or back-facing
+    };
+
+    // Initial capacity of each buffer in elements, they grow by doubling
+    static constexpr size_t InitialVertexCapacity = 1 << 16;
+    static constexpr size_t InitialIndexCapacity = 1 << 18;
+
+private:
+    // Buffers and bump allocator for one vertex format
+    struct Pool {
+        GLVertexArray VAO;          // Attribute layout of the format, bound to VBO and EBO
+        GLBuffer VBO, EBO;          // Vertex and element storage
+        size_t vertexSize = 0;      // Bytes per vertex
+        size_t indexSize = 0;       // Bytes per index
+        size_t vertexCapacity = 0;  // Allocated vertices
+        size_t indexCapacity = 0;   // Allocated indices
+        size_t vertexEnd = 0;       // First unused vertex
+        size_t indexEnd = 0;        // First unused index
+        size_t freedVertices = 0;   // Dead vertices below vertexEnd
+        size_t freedIndices = 0;    // Dead indices below indexEnd
+    };
+
+    // Handle table entry, offsets change when the pool is compacted
+    struct Slot {
+        size_t vertexOffset = 0;
+        size_t vertexCount = 0;
+        size_t indexOffset = 0;
+        size_t indexCount = 0;
+        VertexFormat format = VertexFormat::Float;
+        bool live = false;
+    };
+
+    Pool pools[2];                    // Indexed by VertexFormat
+    std::vector<Slot> slots;          // Handle table
+    std::vector<uint32_t> freeSlots;  // Reusable handle table entries
+    DrawStats drawStats;              // Submissions since the last reset
+
+public:
+    MeshArena() {
+        pools[poolIndex(VertexFormat::Float)].vertexSize = sizeof(Vertex);
+        pools[poolIndex(VertexFormat::Float)].indexSize = sizeof(unsigned int);
+        pools[poolIndex(VertexFormat::Compact)].vertexSize = sizeof(CompactVertex);
+        pools[poolIndex(VertexFormat::Compact)].indexSize = sizeof(uint16_t);
+    }
+
+    MeshArena(const MeshArena&) = delete;
+    MeshArena& operator=(const MeshArena&) = delete;
+
+    // Copies vertices and indices into the arena. Vertex data must be in the
+    // layout of the format (Vertex or CompactVertex), index data in its index
+    // type, relative to the first vertex of this allocation.
+    Allocation allocate(VertexFormat format, const void* vertexData, size_t vertexCount,
+        const void* indexData, size_t indexCount) {
+        Pool& pool = pools[poolIndex(format)];
+        if (pool.vertexEnd + vertexCount > pool.vertexCapacity || pool.indexEnd + indexCount > pool.indexCapacity) {
+            // Grow by doubling, dropping freed ranges on the way
+            size_t liveVertices = pool.vertexEnd - pool.freedVertices + vertexCount;
+            size_t liveIndices = pool.indexEnd - pool.freedIndices + indexCount;
+            relocate(format, std::max({ InitialVertexCapacity, pool.vertexCapacity * 2, liveVertices }),
+                std::max({ InitialIndexCapacity, pool.indexCapacity * 2, liveIndices }));
+        }
+
+        uint32_t id;
+        if (!freeSlots.empty()) {
+            id = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            id = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+        Slot& slot = slots[id];
+        slot.format = format;
+        slot.vertexOffset = pool.vertexEnd;
+        slot.vertexCount = vertexCount;
+        slot.indexOffset = pool.indexEnd;
+        slot.indexCount = indexCount;
+        slot.live = true;
+        pool.vertexEnd += vertexCount;
+        pool.indexEnd += indexCount;
+
+        // Upload through the copy target so no VAO's element binding is touched
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pool.VBO.get());
+        glBufferSubData(GL_COPY_WRITE_BUFFER, slot.vertexOffset * pool.vertexSize, vertexCount * pool.vertexSize, vertexData);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pool.EBO.get());
+        glBufferSubData(GL_COPY_WRITE_BUFFER, slot.indexOffset * pool.indexSize, indexCount * pool.indexSize, indexData);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return Allocation(this, id);
+    }
+
+    // Appends a draw of count indices starting at firstIndex within the allocation
+    void appendDraw(DrawBatch& batch, const Allocation& allocation, size_t firstIndex, GLsizei count) const {
+        const Slot& slot = slots[allocation.getId()];
+        const Pool& pool = pools[poolIndex(slot.format)];
+        batch.counts.push_back(count);
+        batch.offsets.push_back(reinterpret_cast<const void*>((slot.indexOffset + firstIndex) * pool.indexSize));
+        batch.baseVertices.push_back(static_cast<GLint>(slot.vertexOffset));
+    }
+
+    // Submits a batch of draws in one call
+    void draw(VertexFormat format, const DrawBatch& batch) {
+        if (batch.counts.empty()) {
+            return;
+        }
+        drawStats.drawCalls++;
+        drawStats.meshDraws += static_cast<unsigned int>(batch.counts.size());
+        for (GLsizei count : batch.counts) {
+            drawStats.triangles += static_cast<uint64_t>(count / 3);
+        }
+        const Pool& pool = pools[poolIndex(format)];
+        glBindVertexArray(pool.VAO.get());
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, batch.counts.data(), indexType(format),
+            batch.offsets.data(), static_cast<GLsizei>(batch.counts.size()),
+            const_cast<GLint*>(batch.baseVertices.data()));
+        glBindVertexArray(0);
+    }
+
+    // Moves the live ranges of every pool with freed space to the front of fresh
+    // buffers on the GPU, e.g. after a model has been replaced
+    void compact() {
+        for (VertexFormat format : { VertexFormat::Float, VertexFormat::Compact }) {
+            Pool& pool = pools[poolIndex(format)];
+            if (pool.freedVertices == 0 && pool.freedIndices == 0) {
+                continue;
+            }
+            size_t liveVertices = pool.vertexEnd - pool.freedVertices;
+            size_t liveIndices = pool.indexEnd - pool.freedIndices;
+            // Keep a quarter of headroom so the next model rarely has to grow the pool
+            relocate(format, std::max(InitialVertexCapacity, liveVertices + liveVertices / 4),
+                std::max(InitialIndexCapacity, liveIndices + liveIndices / 4));
+        }
+    }
+
+    // Index type used by a format
+    static GLenum indexType(VertexFormat format) {
+        return format == VertexFormat::Float ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+    }
+
+    // Counts meshes and meshlets a model left out of its batch, reported with the draw stats
+    void countCulled(unsigned int meshes, unsigned int meshlets) {
+        drawStats.culledMeshes += meshes;
+        drawStats.culledMeshlets += meshlets;
+    }
+
+    // Returns the submissions since the last call and starts counting anew
+    DrawStats takeDrawStats() {
+        DrawStats stats = drawStats;
+        drawStats = DrawStats();
+        return stats;
+    }
+
+private:
+    // Pool slot of a format
+    static size_t poolIndex(VertexFormat format) {
+        return format == VertexFormat::Float ? 0 : 1;
+    }
+
+    // Marks an allocation's ranges as dead
+    void release(uint32_t id) {
+        Slot& slot = slots[id];
+        Pool& pool = pools[poolIndex(slot.format)];
+        // Ranges at the end are handed straight back to the bump allocator
+        if (slot.vertexOffset + slot.vertexCount == pool.vertexEnd &&
+            slot.indexOffset + slot.indexCount == pool.indexEnd) {
+            pool.vertexEnd -= slot.vertexCount;
+            pool.indexEnd -= slot.indexCount;
+        }
+        else {
+            pool.freedVertices += slot.vertexCount;
+            pool.freedIndices += slot.indexCount;
+        }
+        slot.live = false;
+        freeSlots.push_back(id);
+    }
+
+    // Moves all live ranges of a pool into new buffers of the given capacity
+    void relocate(VertexFormat format, size_t vertexCapacity, size_t indexCapacity) {
+        Pool& pool = pools[poolIndex(format)];
+        GLBuffer vertexBuffer = GLBuffer::create();
+        GLBuffer indexBuffer = GLBuffer::create();
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer.get());
+        glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * pool.vertexSize, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer.get());
+        glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity * pool.indexSize, nullptr, GL_STATIC_DRAW);
+
+        // Copy buffer to buffer on the GPU, updating the handle table as we go
+        size_t vertexEnd = 0, indexEnd = 0;
+        for (Slot& slot : slots) {
+            if (!slot.live || slot.format != format) {
+                continue;
+            }
+            glBindBuffer(GL_COPY_READ_BUFFER, pool.VBO.get());
+            glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer.get());
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, slot.vertexOffset * pool.vertexSize,
+                vertexEnd * pool.vertexSize, slot.vertexCount * pool.vertexSize);
+            glBindBuffer(GL_COPY_READ_BUFFER, pool.EBO.get());
+            glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer.get());
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, slot.indexOffset * pool.indexSize,
+                indexEnd * pool.indexSize, slot.indexCount * pool.indexSize);
+            slot.vertexOffset = vertexEnd;
+            slot.indexOffset = indexEnd;
+            vertexEnd += slot.vertexCount;
+            indexEnd += slot.indexCount;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        pool.VBO = std::move(vertexBuffer);
+        pool.EBO = std::move(indexBuffer);
+        pool.vertexCapacity = vertexCapacity;
+        pool.indexCapacity = indexCapacity;
+        pool.vertexEnd = vertexEnd;
+        pool.indexEnd = indexEnd;
+        pool.freedVertices = 0;
+        pool.freedIndices = 0;
+        setupAttributes(format);
+    }
+
+    // Points the pool's VAO at its current buffers
+    void setupAttributes(VertexFormat format) {
+        Pool& pool = pools[poolIndex(format)];
+        if (!pool.VAO) {
+            pool.VAO = GLVertexArray::create();
+        }
+        glBindVertexArray(pool.VAO.get());
+        glBindBuffer(GL_ARRAY_BUFFER, pool.VBO.get());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool.EBO.get());
+
+        if (format == VertexFormat::Float) {
+            // Set vertex attribute for position (location 0)
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+
+            // Set vertex attribute for normal (location 1)
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                (void*)offsetof(Vertex, Normal));
+        }
+        else {
+            // Quantized position, normalized to [0, 1] and rescaled in the vertex shader
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactVertex),
+                (void*)offsetof(CompactVertex, Position));
+
+            // Octahedral normal, normalized to [-1, 1] and decoded in the vertex shader
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, GL_BYTE, GL_TRUE, sizeof(CompactVertex),
+                (void*)offsetof(CompactVertex, Normal));
+        }
+
+        // Unbind VAO before the array buffer so the element binding stays in the VAO
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // All three objects exist now that they have been bound
+        const bool compact = format == VertexFormat::Compact;
+        GLDiagnostics::label(GL_VERTEX_ARRAY, pool.VAO.get(), compact ? "MeshArena compact VAO" : "MeshArena float VAO");
+        GLDiagnostics::label(GL_BUFFER, pool.VBO.get(), compact ? "MeshArena compact vertices" : "MeshArena float vertices");
+        GLDiagnostics::label(GL_BUFFER, pool.EBO.get(), compact ? "MeshArena compact indices" : "MeshArena float indices");
+    }
+};
+
+#endif
@@ -0,0 +1,378 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "mesh_data.h"
+#include "mapped_file.h"
+
+// On-disk binary cache of imported meshes, so repeat loads skip Assimp entirely.
+// Entries are keyed by the absolute source path and validated against the
+// source size, modification time and content hash.
+class MeshCache {
+public:
+    // Bump whenever the import pipeline or the Vertex layout changes
+    static constexpr uint32_t FormatVersion = 5;
+    // Total size the cache directory is trimmed to after each store
+    static constexpr uint64_t DefaultSizeCap = 1024ull * 1024ull * 1024ull;
+
+private:
+    // File header written at the start of every cache entry
+    struct Header {
+        char magic[8];          // "HOBMESH\0"
+        uint32_t version;       // FormatVersion at write time
+        uint32_t vertexSize;    // sizeof(Vertex) at write time
+        uint64_t pathHash;      // Hash of the absolute source path
+        uint64_t sourceSize;    // Source file size in bytes
+        int64_t sourceMtime;    // Source modification time (file clock ticks)
+        uint64_t contentHash;   // Hash of the source file contents
+        uint64_t meshCount;     // Number of mesh records that follow
+    };
+
+    // Per-mesh record following the header, data is stored after all records
+    struct MeshRecord {
+        uint64_t vertexCount;
+        uint64_t indexCount;
+        uint64_t lodCount;      // Number of LodRecords belonging to this mesh
+        uint32_t meshletCount;
+        uint32_t closed;        // MeshData::closed
+    };
+
+    // Per-level record, all of them follow the mesh records in mesh order
+    struct LodRecord {
+        uint64_t indexCount;
+        float error;
+        uint32_t meshletCount;
+    };
+
+    static_assert(sizeof(Meshlet) == 40, "Meshlet is stored as-is and must stay packed");
+
+    static constexpr char Magic[8] = { 'H', 'O', 'B', 'M', 'E', 'S', 'H', '\0' };
+
+public:
+    // Directory holding cache entries, relative to the working directory
+    static std::filesystem::path& directory() {
+        static std::filesystem::path dir = "cache/meshes";
+        return dir;
+    }
+
+    // Maximum total size of the cache directory in bytes
+    static uint64_t& sizeCap() {
+        static uint64_t cap = DefaultSizeCap;
+        return cap;
+    }
+
+    // 64-bit FNV-1a over 8-byte words, fast enough to stay I/O-bound
+    static uint64_t hashBytes(const unsigned char* data, size_t size, uint64_t seed = 14695981039346656037ull) {
+        const uint64_t prime = 1099511628211ull;
+        uint64_t hash = seed;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            hash = (hash ^ word) * prime;
+        }
+        for (; i < size; i++) {
+            hash = (hash ^ data[i]) * prime;
+        }
+        return hash;
+    }
+
+    // Hashes the contents of a file, returns false if it cannot be read
+    static bool hashFile(const std::string& path, uint64_t& hash) {
+        MappedFile file;
+        if (!file.open(path)) {
+            return false;
+        }
+        hash = hashBytes(file.data(), file.size());
+        return true;
+    }
+
+    // Loads cached meshes for the source path, returns false on a miss.
+    // On a hit the validated source content hash is stored in contentHash.
+    static bool load(const std::string& sourcePath, std::vector<MeshData>& meshes, uint64_t* contentHash = nullptr) {
+        std::error_code ec;
+        std::filesystem::path source = std::filesystem::absolute(sourcePath, ec);
+        if (ec) return false;
+        uint64_t sourceSize = std::filesystem::file_size(source, ec);
+        if (ec) return false;
+        int64_t sourceMtime = static_cast<int64_t>(
+            std::filesystem::last_write_time(source, ec).time_since_epoch().count());
+        if (ec) return false;
+
+        std::filesystem::path entry = entryPath(source);
+        MappedFile file;
+        if (!file.open(entry.string()) || file.size() < sizeof(Header)) {
+            return false;
+        }
+
+        Header header;
+        std::memcpy(&header, file.data(), sizeof(Header));
+        if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 ||
+            header.version != FormatVersion ||
+            header.vertexSize != sizeof(Vertex) ||
+            header.pathHash != hashPath(source) ||
+            header.sourceSize != sourceSize) {
+            return false;
+        }
+
+        // A changed timestamp alone (checkout, copy) is fine if the contents still match
+        bool refreshStamp = false;
+        if (header.sourceMtime != sourceMtime) {
+            uint64_t contentHash;
+            if (!hashFile(source.string(), contentHash) || contentHash != header.contentHash) {
+                return false;
+            }
+            refreshStamp = true;
+        }
+
+        // Validate the record table against the mapped size before touching any data
+        uint64_t offset = sizeof(Header);
+        if (header.meshCount > (file.size() - offset) / sizeof(MeshRecord)) {
+            return false;
+        }
+        std::vector<MeshRecord> records(static_cast<size_t>(header.meshCount));
+        if (!records.empty()) {
+            std::memcpy(records.data(), file.data() + offset, records.size() * sizeof(MeshRecord));
+        }
+        offset += records.size() * sizeof(MeshRecord);
+        uint64_t lodCount = 0;
+        for (const auto& record : records) {
+            if (record.lodCount > (file.size() - offset) / sizeof(LodRecord)) {
+                return false;
+            }
+            lodCount += record.lodCount;
+        }
+        if (lodCount > (file.size() - offset) / sizeof(LodRecord)) {
+            return false;
+        }
+        std::vector<LodRecord> lodRecords(static_cast<size_t>(lodCount));
+        if (!lodRecords.empty()) {
+            std::memcpy(lodRecords.data(), file.data() + offset, lodRecords.size() * sizeof(LodRecord));
+        }
+        offset += lodRecords.size() * sizeof(LodRecord);
+        uint64_t expected = offset;
+        for (const auto& record : records) {
+            expected += record.vertexCount * sizeof(Vertex) + record.indexCount * sizeof(unsigned int) +
+                record.meshletCount * sizeof(Meshlet);
+        }
+        for (const auto& lodRecord : lodRecords) {
+            expected += lodRecord.indexCount * sizeof(unsigned int) + lodRecord.meshletCount * sizeof(Meshlet);
+        }
+        if (expected != file.size()) {
+            return false;
+        }
+
+        // Copy straight out of the mapping into the final buffers
+        std::vector<MeshData> result(records.size());
+        size_t lodIndex = 0;
+        for (size_t i = 0; i < records.size(); i++) {
+            const Vertex* vertices = reinterpret_cast<const Vertex*>(file.data() + offset);
+            result[i].vertices.assign(vertices, vertices + records[i].vertexCount);
+            offset += records[i].vertexCount * sizeof(Vertex);
+
+            const unsigned int* indices = reinterpret_cast<const unsigned int*>(file.data() + offset);
+            result[i].indices.assign(indices, indices + records[i].indexCount);
+            if (!indicesInRange(result[i].indices, result[i].vertices.size())) {
+                return false;
+            }
+            offset += records[i].indexCount * sizeof(unsigned int);
+
+            result[i].meshlets.resize(records[i].meshletCount);
+            if (!readMeshlets(file.data() + offset, result[i].meshlets, result[i].indices.size())) {
+                return false;
+            }
+            offset += records[i].meshletCount * sizeof(Meshlet);
+            result[i].closed = records[i].closed != 0;
+
+            result[i].lods.resize(static_cast<size_t>(records[i].lodCount));
+            for (auto& lod : result[i].lods) {
+                const LodRecord& lodRecord = lodRecords[lodIndex++];
+                const unsigned int* lodIndices = reinterpret_cast<const unsigned int*>(file.data() + offset);
+                lod.indices.assign(lodIndices, lodIndices + lodRecord.indexCount);
+                if (!indicesInRange(lod.indices, result[i].vertices.size())) {
+                    return false;
+                }
+                lod.error = lodRecord.error;
+                offset += lodRecord.indexCount * sizeof(unsigned int);
+                lod.meshlets.resize(lodRecord.meshletCount);
+                if (!readMeshlets(file.data() + offset, lod.meshlets, lod.indices.size())) {
+                    return false;
+                }
+                offset += lodRecord.meshletCount * sizeof(Meshlet);
+            }
+        }
+        file.close();
+
+        if (refreshStamp) {
+            rewriteStamp(entry, sourceMtime);
+        }
+        // Mark the entry as recently used for size-cap eviction
+        std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), ec);
+
+        meshes = std::move(result);
+        if (contentHash) {
+            *contentHash = header.contentHash;
+        }
+        return true;
+    }
+
+    // Stores meshes for the source path and trims the cache to its size cap.
+    // The source content hash is stored in contentHash once it has been computed.
+    static void store(const std::string& sourcePath, const std::vector<MeshData>& meshes, uint64_t* contentHash = nullptr) {
+        std::error_code ec;
+        std::filesystem::path source = std::filesystem::absolute(sourcePath, ec);
+        if (ec) return;
+
+        Header header;
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = FormatVersion;
+        header.vertexSize = sizeof(Vertex);
+        header.pathHash = hashPath(source);
+        header.sourceSize = std::filesystem::file_size(source, ec);
+        if (ec) return;
+        header.sourceMtime = static_cast<int64_t>(
+            std::filesystem::last_write_time(source, ec).time_since_epoch().count());
+        if (ec) return;
+        if (!hashFile(source.string(), header.contentHash)) return;
+        if (contentHash) {
+            *contentHash = header.contentHash;
+        }
+        header.meshCount = meshes.size();
+
+        std::filesystem::create_directories(directory(), ec);
+        std::filesystem::path entry = entryPath(source);
+        std::filesystem::path temp = entry;
+        temp += ".tmp";
+
+        // Write to a temporary file first so a crash never leaves a torn entry
+        {
+            std::ofstream file(temp, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                std::cout << "Mesh cache: cannot write " << temp.string() << std::endl;
+                return;
+            }
+            file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            for (const auto& mesh : meshes) {
+                MeshRecord record = { mesh.vertices.size(), mesh.indices.size(), mesh.lods.size(),
+                    static_cast<uint32_t>(mesh.meshlets.size()), mesh.closed ? 1u : 0u };
+                file.write(reinterpret_cast<const char*>(&record), sizeof(MeshRecord));
+            }
+            for (const auto& mesh : meshes) {
+                for (const auto& lod : mesh.lods) {
+                    LodRecord lodRecord = { lod.indices.size(), lod.error, static_cast<uint32_t>(lod.meshlets.size()) };
+                    file.write(reinterpret_cast<const char*>(&lodRecord), sizeof(LodRecord));
+                }
+            }
+            for (const auto& mesh : meshes) {
+                file.write(reinterpret_cast<const char*>(mesh.vertices.data()),
+                    mesh.vertices.size() * sizeof(Vertex));
+                file.write(reinterpret_cast<const char*>(mesh.indices.data()),
+                    mesh.indices.size() * sizeof(unsigned int));
+                file.write(reinterpret_cast<const char*>(mesh.meshlets.data()),
+                    mesh.meshlets.size() * sizeof(Meshlet));
+                for (const auto& lod : mesh.lods) {
+                    file.write(reinterpret_cast<const char*>(lod.indices.data()),
+                        lod.indices.size() * sizeof(unsigned int));
+                    file.write(reinterpret_cast<const char*>(lod.meshlets.data()),
+                        lod.meshlets.size() * sizeof(Meshlet));
+                }
+            }
+            if (!file.good()) {
+                file.close();
+                std::filesystem::remove(temp, ec);
+                return;
+            }
+        }
+        std::filesystem::rename(temp, entry, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+
+        enforceSizeCap();
+    }
+
+    // Deletes least recently used entries until the cache fits its size cap
+    static void enforceSizeCap() {
+        struct EntryInfo {
+            std::filesystem::path path;
+            uint64_t size;
+            std::filesystem::file_time_type lastUse;
+        };
+
+        std::error_code ec;
+        std::vector<EntryInfo> entries;
+        uint64_t total = 0;
+        for (const auto& item : std::filesystem::directory_iterator(directory(), ec)) {
+            if (!item.is_regular_file(ec) || item.path().extension() != ".mesh") {
+                continue;
+            }
+            EntryInfo info = { item.path(), item.file_size(ec), item.last_write_time(ec) };
+            total += info.size;
+            entries.push_back(info);
+        }
+
+        std::sort(entries.begin(), entries.end(),
+            [](const EntryInfo& a, const EntryInfo& b) { return a.lastUse < b.lastUse; });
+        for (const auto& info : entries) {
+            if (total <= sizeCap()) break;
+            if (std::filesystem::remove(info.path, ec)) {
+                total -= info.size;
+            }
+        }
+    }
+
+private:
+    // Copies meshlets out of the mapping, which gives no alignment guarantee.
+    // Returns false if one reaches past its index list.
+    static bool readMeshlets(const unsigned char* data, std::vector<Meshlet>& meshlets, size_t indexCount) {
+        if (!meshlets.empty()) {
+            std::memcpy(meshlets.data(), data, meshlets.size() * sizeof(Meshlet));
+        }
+        for (const auto& meshlet : meshlets) {
+            if (meshlet.first > indexCount || meshlet.count > indexCount - meshlet.first) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Whether every index refers to one of the vertices; entries carry no
+    // checksum, so a corrupt one must not reach the GPU or the exporters
+    static bool indicesInRange(const std::vector<unsigned int>& indices, size_t vertexCount) {
+        return std::all_of(indices.begin(), indices.end(), [vertexCount](unsigned int index) { return index < vertexCount; });
+    }
+
+    // Hash of the absolute source path, used as entry key
+    static uint64_t hashPath(const std::filesystem::path& source) {
+        std::string key = source.lexically_normal().generic_string();
+        return hashBytes(reinterpret_cast<const unsigned char*>(key.data()), key.size());
+    }
+
+    // Cache entry file for a source path
+    static std::filesystem::path entryPath(const std::filesystem::path& source) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.mesh", static_cast<unsigned long long>(hashPath(source)));
+        return directory() / name;
+    }
+
+    // Updates the stored source timestamp after a successful content check
+    static void rewriteStamp(const std::filesystem::path& entry, int64_t sourceMtime) {
+        std::fstream file(entry, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file.is_open()) return;
+        file.seekp(offsetof(Header, sourceMtime));
+        file.write(reinterpret_cast<const char*>(&sourceMtime), sizeof(sourceMtime));
+    }
+};
+
+#endif
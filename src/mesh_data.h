@@ -0,0 +1,95 @@
+#ifndef MESH_DATA_H
+#define MESH_DATA_H
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Structure to hold vertex data including position and normal
+struct Vertex {
+    glm::vec3 Position; // Vertex position in 3D space
+    glm::vec3 Normal;   // Vertex normal for lighting calculations
+};
+
+// Spatially coherent run of triangles in an index list, with the bounds used to
+// reject it per frame. Stored in the mesh cache, so it must stay plain data.
+struct Meshlet {
+    uint32_t first;         // First index of the run within its index list
+    uint32_t count;         // Number of indices, a multiple of 3
+    glm::vec3 center;       // Bounding sphere center in object space
+    float radius;           // Bounding sphere radius
+    glm::vec3 coneAxis;     // Average facing direction of the triangles
+    float coneCutoff;       // Sine of the normal cone's half angle, 1 if it cannot be back-facing
+};
+
+// Simplified level of detail, indexing the vertices of the full mesh
+struct MeshLod {
+    std::vector<unsigned int> indices;  // Triangle list indices into the mesh vertices
+    float error;                        // Object-space simplification error
+    std::vector<Meshlet> meshlets;      // Clusters covering indices, empty if not built
+};
+
+// CPU-side mesh data as produced by the importers, before any GPU upload
+struct MeshData {
+    std::vector<Vertex> vertices;       // Array of vertices
+    std::vector<unsigned int> indices;  // Triangle list indices into vertices
+    std::vector<MeshLod> lods;          // Reduced levels, coarsest last, empty for small meshes
+    std::vector<Meshlet> meshlets;      // Clusters covering indices, empty if not built
+    bool closed = false;                // Every edge joins two consistently wound triangles
+};
+
+// Replaces degenerate normals with +Y, matching the Assimp import path
+inline glm::vec3 validNormal(const glm::vec3& normal) {
+    return glm::length(normal) < 0.001f ? glm::vec3(0.0f, 1.0f, 0.0f) : normal;
+}
+
+// Matrix that transforms normals like transform does positions: the inverse
+// transpose of its linear part. Rotation with uniform scale s, which is all
+// HairTransform produces, needs no inverse: the result is the matrix divided by s^2.
+inline glm::mat3 normalMatrix(const glm::mat4& transform) {
+    const glm::mat3 linear(transform);
+    const float lengthSquared = glm::dot(linear[0], linear[0]);
+    const float tolerance = 1e-5f * lengthSquared;
+    if (lengthSquared > 0.0f &&
+        std::abs(glm::dot(linear[1], linear[1]) - lengthSquared) <= tolerance &&
+        std::abs(glm::dot(linear[2], linear[2]) - lengthSquared) <= tolerance &&
+        std::abs(glm::dot(linear[0], linear[1])) <= tolerance &&
+        std::abs(glm::dot(linear[0], linear[2])) <= tolerance &&
+        std::abs(glm::dot(linear[1], linear[2])) <= tolerance) {
+        return linear / lengthSquared;
+    }
+    return glm::transpose(glm::inverse(linear));
+}
+
+// Applies a transform to a run of vertices, normals go through the normal matrix
+// (inverse transpose of the transform) and are renormalized
+inline void transformVertices(const Vertex* vertices, size_t count, const glm::mat4& transform,
+    const glm::mat3& normalMatrix, Vertex* out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i].Position = glm::vec3(transform * glm::vec4(vertices[i].Position, 1.0f));
+        out[i].Normal = glm::normalize(normalMatrix * vertices[i].Normal);
+    }
+}
+
+// Area-weighted smooth normals for meshes imported without normals
+inline void computeSmoothNormals(MeshData& mesh) {
+    for (auto& vertex : mesh.vertices) {
+        vertex.Normal = glm::vec3(0.0f);
+    }
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        Vertex& a = mesh.vertices[mesh.indices[i]];
+        Vertex& b = mesh.vertices[mesh.indices[i + 1]];
+        Vertex& c = mesh.vertices[mesh.indices[i + 2]];
+        glm::vec3 faceNormal = glm::cross(b.Position - a.Position, c.Position - a.Position);
+        a.Normal += faceNormal;
+        b.Normal += faceNormal;
+        c.Normal += faceNormal;
+    }
+    for (auto& vertex : mesh.vertices) {
+        float length = glm::length(vertex.Normal);
+        vertex.Normal = length > 0.0f ? validNormal(vertex.Normal / length) : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+}
+
+#endif
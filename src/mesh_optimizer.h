@@ -0,0 +1,296 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "mesh_data.h"
+
+// Import-time mesh optimization: vertex welding, triangle reordering for the
+// post-transform vertex cache and vertex reordering for fetch locality.
+namespace MeshOptimizer {
+
+// Vertex cache efficiency of an index buffer
+struct CacheStats {
+    float acmr = 0.0f; // Average cache miss ratio, transformed vertices per triangle
+    float atvr = 0.0f; // Average transformed vertex ratio, transformed vertices per vertex
+};
+
+// Before/after numbers reported by optimizeMesh
+struct OptimizeReport {
+    size_t verticesBefore = 0;
+    size_t verticesAfter = 0;
+    CacheStats before;
+    CacheStats after;
+};
+
+// Simulates a FIFO post-transform cache of the given size
+inline CacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = 16) {
+    CacheStats stats;
+    if (indices.empty() || vertexCount == 0) {
+        return stats;
+    }
+    std::vector<unsigned int> timestamps(vertexCount, 0);
+    unsigned int time = cacheSize + 1;
+    size_t misses = 0;
+    for (unsigned int index : indices) {
+        if (time - timestamps[index] > cacheSize) {
+            timestamps[index] = time++;
+            misses++;
+        }
+    }
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(vertexCount);
+    return stats;
+}
+
+// Merges bitwise identical vertices and rewrites indices accordingly
+inline void weldVertices(MeshData& mesh) {
+    size_t count = mesh.vertices.size();
+    if (count == 0) {
+        return;
+    }
+    size_t tableSize = 1;
+    while (tableSize < count * 2) tableSize <<= 1;
+    const unsigned int empty = 0xFFFFFFFFu;
+    std::vector<unsigned int> table(tableSize, empty);
+    std::vector<unsigned int> remap(count);
+    std::vector<Vertex> welded;
+    welded.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        const Vertex& vertex = mesh.vertices[i];
+        // FNV-1a over the raw vertex bytes, -0.0 and 0.0 are treated as different
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t b = 0; b < sizeof(Vertex); b++) {
+            hash = (hash ^ bytes[b]) * 1099511628211ull;
+        }
+
+        size_t slot = static_cast<size_t>(hash) & (tableSize - 1);
+        while (table[slot] != empty &&
+            std::memcmp(&welded[table[slot]], &vertex, sizeof(Vertex)) != 0) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+        if (table[slot] == empty) {
+            table[slot] = static_cast<unsigned int>(welded.size());
+            welded.push_back(vertex);
+        }
+        remap[i] = table[slot];
+    }
+
+    for (auto& index : mesh.indices) {
+        index = remap[index];
+    }
+    mesh.vertices = std::move(welded);
+}
+
+// Reorders triangles for post-transform cache reuse (Forsyth, linear-speed
+// vertex cache optimisation), tuned for a 32 entry LRU cache
+inline void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+    const int cacheSize = 32;
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) {
+        return;
+    }
+
+    auto vertexScore = [cacheSize](int cachePosition, unsigned int remaining) {
+        if (remaining == 0) {
+            return -1.0f;
+        }
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            if (cachePosition < 3) {
+                score = 0.75f; // Vertices of the last triangle, fixed so no strip bias
+            }
+            else {
+                float scaled = 1.0f - static_cast<float>(cachePosition - 3) / static_cast<float>(cacheSize - 3);
+                score = std::pow(scaled, 1.5f);
+            }
+        }
+        return score + 2.0f / std::sqrt(static_cast<float>(remaining));
+    };
+
+    // Vertex to triangle adjacency
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int index : indices) {
+        remaining[index]++;
+    }
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<unsigned int> adjacency(indices.size());
+    {
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (int k = 0; k < 3; k++) {
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+            }
+        }
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        vertexScores[v] = vertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] +
+            vertexScores[indices[t * 3 + 2]];
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    std::vector<unsigned int> cache, nextCache;
+    cache.reserve(cacheSize + 3);
+    nextCache.reserve(cacheSize + 3);
+    size_t cursor = 0;
+
+    size_t best = 0;
+    for (size_t t = 1; t < triangleCount; t++) {
+        if (triangleScores[t] > triangleScores[best]) best = t;
+    }
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+        if (best == triangleCount) {
+            // Cache ran dry, continue with the next unemitted triangle in input order
+            while (emitted[cursor]) cursor++;
+            best = cursor;
+        }
+
+        const unsigned int* triangle = &indices[best * 3];
+        emitted[best] = true;
+        output.insert(output.end(), triangle, triangle + 3);
+
+        // Detach the triangle from its vertices
+        for (int k = 0; k < 3; k++) {
+            unsigned int v = triangle[k];
+            unsigned int* begin = &adjacency[offsets[v]];
+            unsigned int* end = begin + remaining[v];
+            unsigned int* found = std::find(begin, end, static_cast<unsigned int>(best));
+            std::swap(*found, *(end - 1));
+            remaining[v]--;
+        }
+
+        // New LRU cache: the emitted triangle first, then the previous contents
+        nextCache.assign(triangle, triangle + 3);
+        for (unsigned int v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                nextCache.push_back(v);
+            }
+        }
+
+        // Update scores of every vertex whose cache position changed
+        for (size_t i = 0; i < nextCache.size(); i++) {
+            unsigned int v = nextCache[i];
+            int position = i < static_cast<size_t>(cacheSize) ? static_cast<int>(i) : -1;
+            cachePositions[v] = position;
+            float score = vertexScore(position, remaining[v]);
+            float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+            for (unsigned int a = offsets[v]; a < offsets[v] + remaining[v]; a++) {
+                triangleScores[adjacency[a]] += delta;
+            }
+        }
+        if (nextCache.size() > static_cast<size_t>(cacheSize)) {
+            nextCache.resize(cacheSize);
+        }
+        std::swap(cache, nextCache);
+
+        // Best candidate among triangles touching cached vertices
+        best = triangleCount;
+        float bestScore = -1.0f;
+        for (unsigned int v : cache) {
+            for (unsigned int a = offsets[v]; a < offsets[v] + remaining[v]; a++) {
+                unsigned int t = adjacency[a];
+                if (triangleScores[t] > bestScore) {
+                    bestScore = triangleScores[t];
+                    best = t;
+                }
+            }
+        }
+    }
+
+    indices = std::move(output);
+}
+
+// Reorders vertices into first-use order of the index buffer and drops unused ones
+inline void optimizeVertexFetch(MeshData& mesh) {
+    const unsigned int unused = 0xFFFFFFFFu;
+    std::vector<unsigned int> remap(mesh.vertices.size(), unused);
+    std::vector<Vertex> ordered;
+    ordered.reserve(mesh.vertices.size());
+    for (auto& index : mesh.indices) {
+        if (remap[index] == unused) {
+            remap[index] = static_cast<unsigned int>(ordered.size());
+            ordered.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices = std::move(ordered);
+}
+
+// Splits a mesh into parts of at most maxVertices vertices each, walking
+// triangles in order so cache-optimized meshes split into compact pieces.
+// sources, if given, receives the index in vertices of every part vertex.
+inline std::vector<MeshData> splitMesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+    size_t maxVertices, std::vector<std::vector<unsigned int>>* sources = nullptr) {
+    std::vector<MeshData> parts;
+    const unsigned int unused = 0xFFFFFFFFu;
+    std::vector<unsigned int> remap(vertices.size(), unused);
+    std::vector<unsigned int> touched;
+    MeshData part;
+
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        size_t added = 0;
+        for (int k = 0; k < 3; k++) {
+            if (remap[indices[t + k]] == unused) added++;
+        }
+        if (part.vertices.size() + added > maxVertices) {
+            for (unsigned int v : touched) remap[v] = unused;
+            if (sources) sources->push_back(touched);
+            touched.clear();
+            parts.push_back(std::move(part));
+            part = MeshData();
+        }
+        for (int k = 0; k < 3; k++) {
+            unsigned int index = indices[t + k];
+            if (remap[index] == unused) {
+                remap[index] = static_cast<unsigned int>(part.vertices.size());
+                part.vertices.push_back(vertices[index]);
+                touched.push_back(index);
+            }
+            part.indices.push_back(remap[index]);
+        }
+    }
+    if (!part.indices.empty()) {
+        if (sources) sources->push_back(touched);
+        parts.push_back(std::move(part));
+    }
+    return parts;
+}
+
+// Runs the full optimization stage on one mesh
+inline OptimizeReport optimizeMesh(MeshData& mesh) {
+    OptimizeReport report;
+    report.verticesBefore = mesh.vertices.size();
+    report.before = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+    weldVertices(mesh);
+    optimizeVertexCache(mesh.indices, mesh.vertices.size());
+    optimizeVertexFetch(mesh);
+
+    report.verticesAfter = mesh.vertices.size();
+    report.after = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+    return report;
+}
+
+} // namespace MeshOptimizer
+
+#endif
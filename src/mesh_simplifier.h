@@ -0,0 +1,323 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+#include "mesh_data.h"
+#include "mesh_optimizer.h"
+
+// Quadric error metric simplification and level of detail generation.
+// Edges are collapsed onto existing vertices only, so every level is just a
+// new index list into the vertex array of the full mesh.
+namespace MeshSimplifier {
+
+// Fractions of the full triangle count kept by the generated levels
+constexpr float LodRatios[] = { 0.5f, 0.25f, 0.1f };
+// Meshes with fewer triangles than this get no reduced levels
+constexpr size_t MinLodTriangles = 1024;
+// Weight of the planes that keep open borders in place, relative to face planes
+constexpr double BorderWeight = 10.0;
+// Upper bound on collapse passes per simplification
+constexpr int MaxPasses = 64;
+
+// Symmetric 4x4 error quadric, accumulated in double precision
+struct Quadric {
+    double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0; // Plane normal outer products
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;                                     // Plane normal times distance
+    double c = 0.0;                                                          // Squared plane distance
+    double w = 0.0;                                                          // Accumulated weight
+
+    // Adds the plane dot(n, p) + d = 0 with the given weight
+    void addPlane(const glm::dvec3& n, double d, double weight) {
+        a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z;
+        a11 += weight * n.y * n.y; a12 += weight * n.y * n.z; a22 += weight * n.z * n.z;
+        b0 += weight * n.x * d; b1 += weight * n.y * d; b2 += weight * n.z * d;
+        c += weight * d * d;
+        w += weight;
+    }
+
+    // Accumulates another quadric
+    void add(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2;
+        c += q.c;
+        w += q.w;
+    }
+
+    // Weighted mean squared distance of p to the accumulated planes
+    double error(const glm::dvec3& p) const {
+        double rx = a00 * p.x + a01 * p.y + a02 * p.z;
+        double ry = a01 * p.x + a11 * p.y + a12 * p.z;
+        double rz = a02 * p.x + a12 * p.y + a22 * p.z;
+        double e = p.x * rx + p.y * ry + p.z * rz + 2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+        return w > 0.0 ? std::abs(e) / w : 0.0;
+    }
+};
+
+// Maps every vertex to the first vertex with a bitwise equal position, so
+// vertices split only by their normal collapse together
+inline std::vector<unsigned int> buildPositionRemap(const std::vector<Vertex>& vertices) {
+    struct PositionHash {
+        size_t operator()(const glm::vec3& p) const {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&p);
+            uint64_t hash = 14695981039346656037ull;
+            for (size_t b = 0; b < sizeof(glm::vec3); b++) {
+                hash = (hash ^ bytes[b]) * 1099511628211ull;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+    std::unordered_map<glm::vec3, unsigned int, PositionHash> first;
+    first.reserve(vertices.size());
+    std::vector<unsigned int> remap(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        remap[i] = first.emplace(vertices[i].Position, static_cast<unsigned int>(i)).first->second;
+    }
+    return remap;
+}
+
+// Simplifies a triangle list down to about targetIndexCount indices. Returns the
+// new index list and stores the object-space error (largest collapse distance)
+// in resultError. Stops early when no further collapse keeps the surface valid,
+// or after the current collapse pass once stopped (if set) returns true.
+inline std::vector<unsigned int> simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+    size_t targetIndexCount, float& resultError, const std::function<bool()>& stopped = nullptr) {
+    resultError = 0.0f;
+    std::vector<unsigned int> result = indices;
+    const size_t vertexCount = vertices.size();
+    if (result.size() <= targetIndexCount || vertexCount == 0) {
+        return result;
+    }
+
+    const std::vector<unsigned int> wedge = buildPositionRemap(vertices);
+    auto position = [&](unsigned int v) { return glm::dvec3(vertices[v].Position); };
+
+    // Face planes, weighted by area, accumulate on the position representatives
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i + 2 < result.size(); i += 3) {
+        unsigned int a = wedge[result[i]], b = wedge[result[i + 1]], c = wedge[result[i + 2]];
+        glm::dvec3 normal = glm::cross(position(b) - position(a), position(c) - position(a));
+        double length = glm::length(normal);
+        if (length == 0.0) continue;
+        normal /= length;
+        double d = -glm::dot(normal, position(a));
+        for (unsigned int v : { a, b, c }) {
+            quadrics[v].addPlane(normal, d, length * 0.5);
+        }
+    }
+
+    // Vertex to triangle adjacency and unique edges, rebuilt every pass
+    std::vector<unsigned int> offsets(vertexCount + 1), adjacency, fill;
+    struct Edge {
+        unsigned int a, b; // Position representatives, a < b
+        unsigned int count; // Number of triangles using the edge
+    };
+    std::vector<Edge> edges;
+    auto buildTopology = [&]() {
+        std::fill(offsets.begin(), offsets.end(), 0u);
+        for (unsigned int index : result) {
+            offsets[wedge[index] + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            offsets[v + 1] += offsets[v];
+        }
+        adjacency.resize(result.size());
+        fill.assign(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < result.size(); i++) {
+            adjacency[fill[wedge[result[i]]]++] = static_cast<unsigned int>(i / 3);
+        }
+
+        // Edges of vertex a to higher neighbours, counted within the one-ring
+        edges.clear();
+        std::vector<std::pair<unsigned int, unsigned int>> ring;
+        for (unsigned int a = 0; a < vertexCount; a++) {
+            ring.clear();
+            for (unsigned int k = offsets[a]; k < offsets[a + 1]; k++) {
+                const unsigned int* triangle = &result[adjacency[k] * 3];
+                for (int corner = 0; corner < 3; corner++) {
+                    unsigned int b = wedge[triangle[corner]];
+                    if (b <= a) continue;
+                    auto found = std::find_if(ring.begin(), ring.end(),
+                        [b](const std::pair<unsigned int, unsigned int>& entry) { return entry.first == b; });
+                    if (found == ring.end()) ring.push_back({ b, 1 });
+                    else found->second++;
+                }
+            }
+            for (const auto& entry : ring) {
+                edges.push_back({ a, entry.first, entry.second });
+            }
+        }
+    };
+
+    // Border planes run through each open edge, perpendicular to its triangle
+    buildTopology();
+    for (const Edge& edge : edges) {
+        if (edge.count != 1) continue;
+        for (unsigned int k = offsets[edge.a]; k < offsets[edge.a + 1]; k++) {
+            const unsigned int* triangle = &result[adjacency[k] * 3];
+            unsigned int t[3] = { wedge[triangle[0]], wedge[triangle[1]], wedge[triangle[2]] };
+            if (t[0] != edge.b && t[1] != edge.b && t[2] != edge.b) continue;
+            glm::dvec3 faceNormal = glm::cross(position(t[1]) - position(t[0]), position(t[2]) - position(t[0]));
+            glm::dvec3 direction = position(edge.b) - position(edge.a);
+            glm::dvec3 normal = glm::cross(direction, faceNormal);
+            double length = glm::length(normal);
+            if (length == 0.0) break;
+            normal /= length;
+            double d = -glm::dot(normal, position(edge.a));
+            double weight = glm::dot(direction, direction) * BorderWeight;
+            quadrics[edge.a].addPlane(normal, d, weight);
+            quadrics[edge.b].addPlane(normal, d, weight);
+            break;
+        }
+    }
+
+    enum VertexKind : unsigned char { Manifold, Border, Locked };
+    std::vector<unsigned char> kinds(vertexCount);
+    std::vector<unsigned int> collapse(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    struct Collapse {
+        unsigned int from, to;
+        double cost;
+        bool border;
+    };
+    std::vector<Collapse> candidates;
+    const size_t targetTriangles = targetIndexCount / 3;
+    double maxCost = 0.0;
+
+    // Rejects collapses that would flip a surviving triangle around from
+    auto flips = [&](unsigned int from, unsigned int to) {
+        for (unsigned int k = offsets[from]; k < offsets[from + 1]; k++) {
+            const unsigned int* triangle = &result[adjacency[k] * 3];
+            unsigned int t[3] = { wedge[triangle[0]], wedge[triangle[1]], wedge[triangle[2]] };
+            if (t[0] == to || t[1] == to || t[2] == to) continue;
+            glm::dvec3 p[3] = { position(t[0]), position(t[1]), position(t[2]) };
+            glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            for (int corner = 0; corner < 3; corner++) {
+                if (t[corner] == from) p[corner] = position(to);
+            }
+            glm::dvec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+            if (glm::dot(before, after) <= 0.0) return true;
+        }
+        return false;
+    };
+
+    for (int pass = 0; pass < MaxPasses && result.size() / 3 > targetTriangles; pass++) {
+        if (stopped && stopped()) break;
+        if (pass > 0) buildTopology();
+
+        // Classify vertices by the edges around them
+        std::fill(kinds.begin(), kinds.end(), Manifold);
+        for (const Edge& edge : edges) {
+            unsigned char kind = edge.count == 1 ? Border : edge.count > 2 ? Locked : Manifold;
+            kinds[edge.a] = std::max(kinds[edge.a], kind);
+            kinds[edge.b] = std::max(kinds[edge.b], kind);
+        }
+
+        // Border vertices may only slide along the border, locked ones never move
+        candidates.clear();
+        for (const Edge& edge : edges) {
+            if (edge.count > 2) continue;
+            bool border = edge.count == 1;
+            auto allowed = [&](unsigned int from) {
+                return kinds[from] == Manifold || (kinds[from] == Border && border);
+            };
+            Quadric combined = quadrics[edge.a];
+            combined.add(quadrics[edge.b]);
+            double costToB = allowed(edge.a) ? combined.error(position(edge.b)) : -1.0;
+            double costToA = allowed(edge.b) ? combined.error(position(edge.a)) : -1.0;
+            if (costToB >= 0.0 && (costToA < 0.0 || costToB <= costToA)) {
+                candidates.push_back({ edge.a, edge.b, costToB, border });
+            }
+            else if (costToA >= 0.0) {
+                candidates.push_back({ edge.b, edge.a, costToA, border });
+            }
+        }
+        if (candidates.empty()) break;
+        std::sort(candidates.begin(), candidates.end(),
+            [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        // Greedy independent collapses from the cheapest third of the edges
+        for (unsigned int v = 0; v < vertexCount; v++) collapse[v] = v;
+        std::fill(touched.begin(), touched.end(), false);
+        const size_t needed = result.size() / 3 - targetTriangles;
+        const size_t limit = candidates.size() / 3 + 1;
+        size_t removed = 0, collapsed = 0;
+        for (size_t i = 0; i < limit && removed < needed; i++) {
+            const Collapse& candidate = candidates[i];
+            if (touched[candidate.from] || touched[candidate.to] || flips(candidate.from, candidate.to)) {
+                continue;
+            }
+            collapse[candidate.from] = candidate.to;
+            quadrics[candidate.to].add(quadrics[candidate.from]);
+            // Freeze the one-ring so every checked triangle changes at most once per pass
+            for (unsigned int k = offsets[candidate.from]; k < offsets[candidate.from + 1]; k++) {
+                const unsigned int* triangle = &result[adjacency[k] * 3];
+                for (int corner = 0; corner < 3; corner++) touched[wedge[triangle[corner]]] = true;
+            }
+            touched[candidate.to] = true;
+            maxCost = std::max(maxCost, candidate.cost);
+            removed += candidate.border ? 1 : 2;
+            collapsed++;
+        }
+        if (collapsed == 0) break;
+
+        // Apply the collapses and drop triangles that became degenerate
+        size_t write = 0;
+        for (size_t i = 0; i + 2 < result.size(); i += 3) {
+            unsigned int t[3], w[3];
+            for (int corner = 0; corner < 3; corner++) {
+                unsigned int target = collapse[wedge[result[i + corner]]];
+                t[corner] = target != wedge[result[i + corner]] ? target : result[i + corner];
+                w[corner] = wedge[t[corner]];
+            }
+            if (w[0] == w[1] || w[1] == w[2] || w[0] == w[2]) continue;
+            result[write++] = t[0];
+            result[write++] = t[1];
+            result[write++] = t[2];
+        }
+        result.resize(write);
+    }
+
+    resultError = static_cast<float>(std::sqrt(maxCost));
+    return result;
+}
+
+// Builds the reduced levels of a mesh, each simplified from the previous one.
+// Returns false if stopped (if set) returned true, which is checked before each
+// collapse pass; the levels are incomplete then.
+inline bool buildLods(MeshData& mesh, const std::function<bool()>& stopped = nullptr) {
+    mesh.lods.clear();
+    const size_t triangleCount = mesh.indices.size() / 3;
+    if (triangleCount < MinLodTriangles) {
+        return true;
+    }
+    float error = 0.0f;
+    for (float ratio : LodRatios) {
+        const std::vector<unsigned int>& source = mesh.lods.empty() ? mesh.indices : mesh.lods.back().indices;
+        size_t target = static_cast<size_t>(static_cast<float>(triangleCount) * ratio) * 3;
+        float levelError = 0.0f;
+        std::vector<unsigned int> lod = simplify(mesh.vertices, source, target, levelError, stopped);
+        if (stopped && stopped()) {
+            return false;
+        }
+        // Stop once simplification stalls, e.g. on geometry made of locked vertices
+        if (lod.empty() || lod.size() > source.size() * 9 / 10) {
+            break;
+        }
+        MeshOptimizer::optimizeVertexCache(lod, mesh.vertices.size());
+        // Errors of chained levels add up, keeping the estimate conservative
+        error += levelError;
+        mesh.lods.push_back({ std::move(lod), error, {} });
+    }
+    return true;
+}
+
+} // namespace MeshSimplifier
+
+#endif
@@ -0,0 +1,244 @@
+#ifndef MESHLET_BUILDER_H
+#define MESHLET_BUILDER_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "mesh_data.h"
+
+// Import-time partitioning of index lists into meshlets: clusters of roughly
+// MinTriangles to MaxTriangles connected triangles with similar facing, each
+// stored as one contiguous run of the index list. Their bounding spheres and
+// normal cones let the renderer skip off-screen and back-facing clusters.
+namespace MeshletBuilder {
+
+// A cluster stops growing at this size
+constexpr size_t MaxTriangles = 128;
+// Below this size a cluster also takes triangles that widen its normal cone
+constexpr size_t MinTriangles = 64;
+// Past MinTriangles, triangles facing further than this from the cluster
+// (cosine) start a new cluster instead, which keeps cones cullable
+constexpr float ConeLimit = 0.7f;
+// Meshlets built between two checks of the stop callback
+constexpr size_t StopCheckInterval = 256;
+
+// Whether every directed edge has exactly one opposite edge, i.e. the surface is
+// watertight and consistently wound, so its back faces can never be seen from outside
+inline bool isClosed(const std::vector<unsigned int>& indices) {
+    if (indices.size() < 3) {
+        return false;
+    }
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size() / 3 * 3);
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        for (int k = 0; k < 3; k++) {
+            uint64_t from = indices[t + k], to = indices[t + (k + 1) % 3];
+            if (from == to) {
+                return false;
+            }
+            edges.push_back((from << 32) | to);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    for (size_t i = 0; i < edges.size(); i++) {
+        if (i + 1 < edges.size() && edges[i + 1] == edges[i]) {
+            return false;
+        }
+        const uint64_t reversed = (edges[i] << 32) | (edges[i] >> 32);
+        if (!std::binary_search(edges.begin(), edges.end(), reversed)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Bounding sphere and normal cone of a run of triangles
+inline Meshlet computeMeshlet(const std::vector<Vertex>& vertices, const unsigned int* indices, size_t count) {
+    Meshlet meshlet;
+    meshlet.count = static_cast<uint32_t>(count);
+    glm::vec3 minimum(vertices[indices[0]].Position), maximum(minimum);
+    for (size_t i = 1; i < count; i++) {
+        minimum = glm::min(minimum, vertices[indices[i]].Position);
+        maximum = glm::max(maximum, vertices[indices[i]].Position);
+    }
+    meshlet.center = (minimum + maximum) * 0.5f;
+    float radiusSquared = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 offset = vertices[indices[i]].Position - meshlet.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    meshlet.radius = std::sqrt(radiusSquared);
+
+    // Cone around the mean facing of the non-degenerate triangles
+    std::vector<glm::vec3> normals;
+    normals.reserve(count / 3);
+    glm::vec3 sum(0.0f);
+    for (size_t t = 0; t + 2 < count; t += 3) {
+        const glm::vec3& a = vertices[indices[t]].Position;
+        glm::vec3 normal = glm::cross(vertices[indices[t + 1]].Position - a, vertices[indices[t + 2]].Position - a);
+        float length = glm::length(normal);
+        if (length > 0.0f) {
+            normals.push_back(normal / length);
+            sum += normals.back();
+        }
+    }
+    float sumLength = glm::length(sum);
+    meshlet.coneAxis = sumLength > 0.0f ? sum / sumLength : glm::vec3(0.0f, 0.0f, 1.0f);
+    float minimumDot = normals.empty() ? -1.0f : 1.0f;
+    for (const auto& normal : normals) {
+        minimumDot = std::min(minimumDot, glm::dot(normal, meshlet.coneAxis));
+    }
+    // Cones of 90 degrees or more always contain a front face
+    meshlet.coneCutoff = minimumDot > 0.0f ? std::sqrt(1.0f - minimumDot * minimumDot) : 1.0f;
+    return meshlet;
+}
+
+// Reorders the triangles of an index list into meshlets and returns them. Seeds
+// are taken in the existing triangle order and triangles keep that order inside
+// their meshlet, so cache-optimized lists stay mostly cache-friendly. Every
+// StopCheckInterval meshlets, stopped (if set) may end the build by returning
+// true; the indices are left unchanged and no meshlets are returned then.
+inline std::vector<Meshlet> buildMeshlets(const std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
+    const std::function<bool()>& stopped = nullptr) {
+    std::vector<Meshlet> meshlets;
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return meshlets;
+    }
+
+    // Triangles around each vertex, compressed
+    std::vector<unsigned int> offsets(vertices.size() + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        offsets[indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < vertices.size(); v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<unsigned int> adjacency(triangleCount * 3);
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+
+    std::vector<glm::vec3> faceNormals(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++) {
+        const glm::vec3& a = vertices[indices[t * 3]].Position;
+        glm::vec3 normal = glm::cross(vertices[indices[t * 3 + 1]].Position - a, vertices[indices[t * 3 + 2]].Position - a);
+        float length = glm::length(normal);
+        faceNormals[t] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+    }
+
+    // Stamps of the current meshlet, so nothing has to be cleared between meshlets
+    const unsigned int none = 0xFFFFFFFFu;
+    std::vector<unsigned int> triangleMeshlet(triangleCount, none);  // Meshlet a triangle was put in
+    std::vector<unsigned int> candidateStamp(triangleCount, none);   // Meshlet that listed it as candidate
+    std::vector<unsigned int> vertexStamp(vertices.size(), none);    // Meshlet that uses the vertex
+
+    std::vector<unsigned int> reordered;
+    reordered.reserve(indices.size());
+    std::vector<unsigned int> members, candidates;
+    size_t seed = 0;
+    while (true) {
+        while (seed < triangleCount && triangleMeshlet[seed] != none) {
+            seed++;
+        }
+        if (seed == triangleCount) {
+            break;
+        }
+        if (stopped && meshlets.size() % StopCheckInterval == 0 && stopped()) {
+            return {};
+        }
+        const unsigned int id = static_cast<unsigned int>(meshlets.size());
+        members.clear();
+        candidates.clear();
+        glm::vec3 normalSum(0.0f);
+
+        auto add = [&](unsigned int triangle) {
+            triangleMeshlet[triangle] = id;
+            members.push_back(triangle);
+            normalSum += faceNormals[triangle];
+            for (int k = 0; k < 3; k++) {
+                unsigned int vertex = indices[triangle * 3 + k];
+                vertexStamp[vertex] = id;
+                for (unsigned int a = offsets[vertex]; a < offsets[vertex + 1]; a++) {
+                    unsigned int neighbour = adjacency[a];
+                    if (triangleMeshlet[neighbour] == none && candidateStamp[neighbour] != id) {
+                        candidateStamp[neighbour] = id;
+                        candidates.push_back(neighbour);
+                    }
+                }
+            }
+        };
+        add(static_cast<unsigned int>(seed));
+
+        while (members.size() < MaxTriangles) {
+            // Prefer triangles closing gaps (more shared vertices), then similar facing
+            const float axisLength = glm::length(normalSum);
+            const glm::vec3 axis = axisLength > 0.0f ? normalSum / axisLength : glm::vec3(0.0f);
+            size_t best = candidates.size();
+            float bestScore = -1e30f;
+            for (size_t c = 0; c < candidates.size();) {
+                unsigned int triangle = candidates[c];
+                if (triangleMeshlet[triangle] != none) {
+                    candidates[c] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+                int shared = 0;
+                for (int k = 0; k < 3; k++) {
+                    shared += vertexStamp[indices[triangle * 3 + k]] == id ? 1 : 0;
+                }
+                float score = static_cast<float>(shared) + glm::dot(faceNormals[triangle], axis);
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = c;
+                }
+                c++;
+            }
+            if (best == candidates.size()) {
+                break;
+            }
+            unsigned int triangle = candidates[best];
+            if (members.size() >= MinTriangles && glm::dot(faceNormals[triangle], axis) < ConeLimit) {
+                break;
+            }
+            candidates[best] = candidates.back();
+            candidates.pop_back();
+            add(triangle);
+        }
+
+        std::sort(members.begin(), members.end());
+        const size_t first = reordered.size();
+        for (unsigned int triangle : members) {
+            reordered.insert(reordered.end(), indices.begin() + triangle * 3, indices.begin() + triangle * 3 + 3);
+        }
+        Meshlet meshlet = computeMeshlet(vertices, reordered.data() + first, reordered.size() - first);
+        meshlet.first = static_cast<uint32_t>(first);
+        meshlets.push_back(meshlet);
+    }
+    indices = std::move(reordered);
+    return meshlets;
+}
+
+// Builds meshlets for the full mesh and every level and checks whether it is
+// closed. Returns false if stopped (if set) returned true, which is checked
+// before each level and within the builds; the meshlets are incomplete then.
+inline bool buildMeshlets(MeshData& mesh, const std::function<bool()>& stopped = nullptr) {
+    mesh.closed = isClosed(mesh.indices);
+    mesh.meshlets = buildMeshlets(mesh.vertices, mesh.indices, stopped);
+    for (auto& lod : mesh.lods) {
+        if (stopped && stopped()) {
+            return false;
+        }
+        lod.meshlets = buildMeshlets(mesh.vertices, lod.indices, stopped);
+    }
+    return !(stopped && stopped());
+}
+
+} // namespace MeshletBuilder
+
+#endif
@@ -5,106 +5,567 @@
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <assimp/ProgressHandler.hpp>
 #include <vector>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <fstream>
 #include <iostream>
-#include <sstream>
-#include <iomanip>
 #include "shader.h"
+#include "gl_handle.h"
+#include "mesh_arena.h"
+#include "mesh_data.h"
+#include "mesh_cache.h"
+#include "obj_reader.h"
+#include "obj_writer.h"
+#include "ply_writer.h"
+#include "glb_writer.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "meshlet_builder.h"
+#include "vertex_format.h"
+#include "bounds.h"
+#include "frustum.h"
+#include "worker_pool.h"
+#include "draco_io.h"
+#include "profiler.h"
+
+// Output settings for saving a model
+struct SaveSettings {
+    int objPrecision = ObjWriter::DefaultPrecision; // Decimals per coordinate in OBJ files
+    DracoIO::Settings draco;                        // Quantization for .drc files
+};
 
-// Structure to hold vertex data including position and normal
-struct Vertex {
-    glm::vec3 Position; // Vertex position in 3D space
-    glm::vec3 Normal;   // Vertex normal for lighting calculations
+// Camera parameters used to cull meshes and meshlets and pick levels of detail
+struct LodView {
+    glm::mat4 model;            // Model matrix the mesh is drawn with
+    glm::mat4 viewProjection;   // Projection times view matrix of the camera
+    glm::vec3 cameraPosition;   // Camera position in world space
+    float fov;                  // Vertical field of view in degrees
+    float viewportHeight;       // Viewport height in pixels
+    float pixelError = 1.0f;    // Largest acceptable simplification error on screen, in pixels
+    bool backFaceCulling = true;    // Reject back-facing meshlets of closed meshes
+    bool openMeshBackFaces = false; // Also reject them in open meshes, whose back faces can be visible
+    WorkerPool* workers = nullptr;  // Runs meshlet culling in parallel, inline when null
 };
 
-// Structure representing a mesh with vertices, indices, and OpenGL buffers
+// Structure representing the GPU copy of a mesh.
+// Meshes own their ranges in the mesh arena and are move-only, so replacing a
+// model frees them. The full-precision CPU copy lives in the owning Model.
 struct Mesh {
-    std::vector<Vertex> vertices;          // Array of vertices
-    std::vector<unsigned int> indices;    // Array of indices for indexed drawing
-    unsigned int VAO, VBO, EBO;           // OpenGL buffer objects
+    // Index range of one level of detail inside a part's allocation
+    struct IndexRange {
+        size_t first = 0;       // First index relative to the allocation
+        GLsizei count = 0;      // Number of indices, 0 if the level has no triangles in this part
+        std::vector<Meshlet> meshlets; // Clusters with first relative to the range, none draws it whole
+    };
+
+    // One uploaded piece of the mesh, compact meshes may need several
+    struct Part {
+        MeshArena::Allocation allocation; // Vertices and the index lists of all levels
+        std::vector<IndexRange> levels;   // Index range per level of detail
+    };
+
+    // Below this fraction of the pixel error a coarser level is taken, the gap
+    // between switching down and back up keeps levels from popping at the threshold
+    static constexpr float LodHysteresis = 0.75f;
+
+    std::vector<Part> parts;              // GPU copy of the mesh
+    std::vector<float> lodErrors;         // Object-space error per level, level 0 is the full mesh
+    Bounds bounds;                        // Object-space bounds, computed once at upload
+    size_t currentLod;                    // Level drawn last, for hysteresis
+    bool closed;                          // Back faces can only be seen from inside
+
+    // Constructor uploads the mesh data into the arena in the given format,
+    // compact positions are quantized against the given box
+    Mesh(const MeshData& data, MeshArena& arena, VertexFormat format, const QuantizationBox& quantization)
+        : currentLod(0), closed(data.closed) {
+        setupMesh(data, arena, format, quantization);
+    }
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+    Mesh(Mesh&&) noexcept = default;
+    Mesh& operator=(Mesh&&) noexcept = default;
+
+    // Uploads vertices and all levels, which share the vertices of their part
+    void setupMesh(const MeshData& data, MeshArena& arena, VertexFormat format, const QuantizationBox& quantization) {
+        const std::vector<Vertex>& vertices = data.vertices;
+        parts.clear();
+        currentLod = 0;
+        lodErrors.assign(1, 0.0f);
+        for (const auto& lod : data.lods) {
+            lodErrors.push_back(lod.error);
+        }
+        bounds = computeBounds(vertices);
+        if (vertices.empty() || data.indices.empty()) {
+            return;
+        }
+
+        std::vector<const std::vector<unsigned int>*> levels = { &data.indices };
+        std::vector<const std::vector<Meshlet>*> levelMeshlets = { &data.meshlets };
+        for (const auto& lod : data.lods) {
+            levels.push_back(&lod.indices);
+            levelMeshlets.push_back(&lod.meshlets);
+        }
+
+        if (format == VertexFormat::Float) {
+            parts.push_back(uploadPart(arena, vertices.data(), vertices.size(), levels, format));
+        }
+        else if (vertices.size() <= CompactMaxVertices) {
+            std::vector<CompactVertex> packed = packVertices(vertices, quantization);
+            parts.push_back(uploadPart(arena, packed.data(), packed.size(), levels, format));
+        }
+        else {
+            setupSplitMesh(vertices, levels, levelMeshlets, arena, quantization);
+            return;
+        }
+        for (size_t level = 0; level < levels.size(); level++) {
+            parts.back().levels[level].meshlets = *levelMeshlets[level];
+        }
+    }
+
+    // Picks the level for the view: the coarsest one whose projected error stays
+    // below the pixel threshold, with hysteresis against popping
+    size_t selectLod(const LodView& view) {
+        if (lodErrors.size() < 2) {
+            return currentLod = 0;
+        }
+        Bounds world = transformBounds(bounds, view.model);
+        float scale = bounds.radius > 0.0f ? world.radius / bounds.radius : 1.0f;
+        float distance = std::max(glm::length(view.cameraPosition - world.center) - world.radius, 1e-4f);
+        float pixelsPerUnit = view.viewportHeight / (2.0f * std::tan(glm::radians(view.fov) * 0.5f) * distance);
+        auto coarsestWithin = [&](float threshold) {
+            size_t level = 0;
+            while (level + 1 < lodErrors.size() && lodErrors[level + 1] * scale * pixelsPerUnit <= threshold) {
+                level++;
+            }
+            return level;
+        };
 
-    // Constructor initializes mesh with vertices and indices
-    Mesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
-        : vertices(vertices), indices(indices) {
-        setupMesh();
+        currentLod = std::min(currentLod, lodErrors.size() - 1);
+        size_t relaxed = coarsestWithin(view.pixelError * LodHysteresis);
+        if (relaxed > currentLod) {
+            currentLod = relaxed;
+        }
+        else if (lodErrors[currentLod] * scale * pixelsPerUnit > view.pixelError) {
+            currentLod = coarsestWithin(view.pixelError);
+        }
+        return currentLod;
     }
 
-    // Sets up OpenGL buffers and vertex attributes
-    void setupMesh() {
-        // Generate vertex array object
-        glGenVertexArrays(1, &VAO);
-        // Generate vertex buffer object
-        glGenBuffers(1, &VBO);
-        // Generate element buffer object
-        glGenBuffers(1, &EBO);
+    // Adds the draws of one level to a batch
+    void appendDraws(const MeshArena& arena, DrawBatch& batch, size_t level = 0) const {
+        for (const auto& part : parts) {
+            const IndexRange& range = part.levels[std::min(level, part.levels.size() - 1)];
+            if (range.count > 0) {
+                arena.appendDraw(batch, part.allocation, range.first, range.count);
+            }
+        }
+    }
 
-        // Bind VAO for setting up vertex attributes
-        glBindVertexArray(VAO);
+private:
+    // Triangles of one level assigned to a piece of the split full mesh
+    struct PieceLevel {
+        std::vector<unsigned int> indices;  // Indices local to the piece
+        std::vector<Meshlet> meshlets;      // Meshlet runs within indices
+    };
 
-        // Bind and fill vertex buffer
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        if (!vertices.empty()) {
-            glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex),
-                vertices.data(), GL_STATIC_DRAW);
+    // Uploads a compact mesh too large for 16-bit indices. The full mesh is split
+    // once and every coarser level is drawn from the same pieces: each triangle
+    // goes to a piece holding all three of its vertices, and each meshlet is cut
+    // into the runs that landed in each piece. Only triangles that span pieces
+    // are split again per level into extra parts with their own vertices.
+    void setupSplitMesh(const std::vector<Vertex>& vertices, const std::vector<const std::vector<unsigned int>*>& levels,
+        const std::vector<const std::vector<Meshlet>*>& levelMeshlets, MeshArena& arena,
+        const QuantizationBox& quantization) {
+        std::vector<std::vector<unsigned int>> sources;
+        std::vector<MeshData> pieces = MeshOptimizer::splitMesh(vertices, *levels[0], CompactMaxVertices, &sources);
+        const unsigned int none = 0xFFFFFFFFu;
+
+        // First piece holding each vertex with its local index there; vertices on
+        // piece borders also appear in later pieces, those are kept in extra
+        std::vector<unsigned int> homePiece(vertices.size(), none), homeIndex(vertices.size(), none);
+        std::unordered_map<uint64_t, unsigned int> extra;
+        for (size_t p = 0; p < sources.size(); p++) {
+            for (size_t local = 0; local < sources[p].size(); local++) {
+                unsigned int vertex = sources[p][local];
+                if (homePiece[vertex] == none) {
+                    homePiece[vertex] = static_cast<unsigned int>(p);
+                    homeIndex[vertex] = static_cast<unsigned int>(local);
+                }
+                else {
+                    extra.emplace((static_cast<uint64_t>(p) << 32) | vertex, static_cast<unsigned int>(local));
+                }
+            }
+        }
+        auto localIndex = [&](unsigned int piece, unsigned int vertex) {
+            if (homePiece[vertex] == piece) {
+                return homeIndex[vertex];
+            }
+            auto found = extra.find((static_cast<uint64_t>(piece) << 32) | vertex);
+            return found == extra.end() ? none : found->second;
+        };
+
+        // Distribute the coarser levels, the last destination collects spanning triangles
+        const size_t pieceCount = pieces.size();
+        std::vector<std::vector<PieceLevel>> pieceLevels(levels.size(), std::vector<PieceLevel>(pieceCount + 1));
+        for (size_t level = 1; level < levels.size(); level++) {
+            const std::vector<unsigned int>& indices = *levels[level];
+            std::vector<PieceLevel>& targets = pieceLevels[level];
+            // Meshlets are the units whose runs are tracked, without any the whole list is one
+            std::vector<Meshlet> units = *levelMeshlets[level];
+            const bool hasMeshlets = !units.empty();
+            if (!hasMeshlets) {
+                Meshlet whole = Meshlet();
+                whole.count = static_cast<uint32_t>(indices.size());
+                units.push_back(whole);
+            }
+            std::vector<size_t> runStart(pieceCount + 1);
+            for (const Meshlet& unit : units) {
+                for (size_t d = 0; d <= pieceCount; d++) {
+                    runStart[d] = targets[d].indices.size();
+                }
+                unsigned int lastPiece = none;
+                for (size_t t = unit.first; t + 2 < static_cast<size_t>(unit.first) + unit.count; t += 3) {
+                    // Try the piece of the previous triangle first, then the pieces of the corners
+                    const unsigned int candidates[4] = { lastPiece, homePiece[indices[t]], homePiece[indices[t + 1]],
+                        homePiece[indices[t + 2]] };
+                    bool placed = false;
+                    for (unsigned int piece : candidates) {
+                        if (piece == none) {
+                            continue;
+                        }
+                        unsigned int a = localIndex(piece, indices[t]);
+                        unsigned int b = localIndex(piece, indices[t + 1]);
+                        unsigned int c = localIndex(piece, indices[t + 2]);
+                        if (a != none && b != none && c != none) {
+                            targets[piece].indices.insert(targets[piece].indices.end(), { a, b, c });
+                            lastPiece = piece;
+                            placed = true;
+                            break;
+                        }
+                    }
+                    if (!placed) {
+                        targets[pieceCount].indices.insert(targets[pieceCount].indices.end(),
+                            indices.begin() + t, indices.begin() + t + 3);
+                    }
+                }
+                if (!hasMeshlets) {
+                    continue;
+                }
+                for (size_t d = 0; d <= pieceCount; d++) {
+                    if (targets[d].indices.size() > runStart[d]) {
+                        Meshlet run = unit;
+                        run.first = static_cast<uint32_t>(runStart[d]);
+                        run.count = static_cast<uint32_t>(targets[d].indices.size() - runStart[d]);
+                        targets[d].meshlets.push_back(run);
+                    }
+                }
+            }
         }
 
-        // Bind and fill index buffer
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        if (!indices.empty()) {
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
-                indices.data(), GL_STATIC_DRAW);
+        // One part per piece holding the full mesh's run and its share of every level
+        size_t pieceStart = 0;
+        for (size_t p = 0; p < pieceCount; p++) {
+            std::vector<const std::vector<unsigned int>*> partLevels(levels.size(), nullptr);
+            partLevels[0] = &pieces[p].indices;
+            for (size_t level = 1; level < levels.size(); level++) {
+                if (!pieceLevels[level][p].indices.empty()) {
+                    partLevels[level] = &pieceLevels[level][p].indices;
+                }
+            }
+            std::vector<CompactVertex> packed = packVertices(pieces[p].vertices, quantization);
+            parts.push_back(uploadPart(arena, packed.data(), packed.size(), partLevels, VertexFormat::Compact));
+            parts.back().levels[0].meshlets =
+                clipMeshlets(*levelMeshlets[0], pieceStart, pieceStart + pieces[p].indices.size());
+            pieceStart += pieces[p].indices.size();
+            for (size_t level = 1; level < levels.size(); level++) {
+                parts.back().levels[level].meshlets = std::move(pieceLevels[level][p].meshlets);
+            }
         }
 
-        // Set vertex attribute for position (location 0)
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        // Spanning triangles, split per level into consecutive runs like the full mesh
+        for (size_t level = 1; level < levels.size(); level++) {
+            const PieceLevel& spanning = pieceLevels[level][pieceCount];
+            size_t runStart = 0;
+            for (const auto& piece : MeshOptimizer::splitMesh(vertices, spanning.indices, CompactMaxVertices)) {
+                std::vector<const std::vector<unsigned int>*> partLevels(levels.size(), nullptr);
+                partLevels[level] = &piece.indices;
+                std::vector<CompactVertex> packed = packVertices(piece.vertices, quantization);
+                parts.push_back(uploadPart(arena, packed.data(), packed.size(), partLevels, VertexFormat::Compact));
+                parts.back().levels[level].meshlets =
+                    clipMeshlets(spanning.meshlets, runStart, runStart + piece.indices.size());
+                runStart += piece.indices.size();
+            }
+        }
+    }
 
-        // Set vertex attribute for normal (location 1)
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-            (void*)offsetof(Vertex, Normal));
+    // Meshlets overlapping the index window [begin, end) of their list, cut to the
+    // window and made relative to its start. Cut meshlets keep their bounds, which
+    // still enclose the remaining triangles.
+    static std::vector<Meshlet> clipMeshlets(const std::vector<Meshlet>& meshlets, size_t begin, size_t end) {
+        std::vector<Meshlet> clipped;
+        for (const auto& meshlet : meshlets) {
+            size_t first = std::max<size_t>(meshlet.first, begin);
+            size_t last = std::min<size_t>(meshlet.first + meshlet.count, end);
+            if (first < last) {
+                Meshlet piece = meshlet;
+                piece.first = static_cast<uint32_t>(first - begin);
+                piece.count = static_cast<uint32_t>(last - first);
+                clipped.push_back(piece);
+            }
+        }
+        return clipped;
+    }
 
-        // Unbind VAO
-        glBindVertexArray(0);
+    // Quantizes vertices into the compact layout
+    static std::vector<CompactVertex> packVertices(const std::vector<Vertex>& vertices, const QuantizationBox& quantization) {
+        std::vector<CompactVertex> packed(vertices.size());
+        for (size_t v = 0; v < vertices.size(); v++) {
+            packed[v] = packCompactVertex(vertices[v], quantization);
+        }
+        return packed;
     }
 
-    // Draws the mesh using the provided shader
-    void Draw(Shader& shader) const {
-        if (vertices.empty() || indices.empty()) {
-            return;
+    // Allocates one part in the arena. The index lists of all levels are stored
+    // back to back, levels passed as null stay empty in this part.
+    static Part uploadPart(MeshArena& arena, const void* vertexData, size_t vertexCount,
+        const std::vector<const std::vector<unsigned int>*>& levels, VertexFormat format) {
+        Part part;
+        part.levels.resize(levels.size());
+        size_t indexCount = 0;
+        for (size_t level = 0; level < levels.size(); level++) {
+            if (levels[level]) {
+                part.levels[level].first = indexCount;
+                part.levels[level].count = static_cast<GLsizei>(levels[level]->size());
+                indexCount += levels[level]->size();
+            }
         }
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()),
-            GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+
+        if (format == VertexFormat::Float) {
+            std::vector<unsigned int> indices;
+            indices.reserve(indexCount);
+            for (const auto* level : levels) {
+                if (level) indices.insert(indices.end(), level->begin(), level->end());
+            }
+            part.allocation = arena.allocate(format, vertexData, vertexCount, indices.data(), indices.size());
+        }
+        else {
+            std::vector<uint16_t> indices;
+            indices.reserve(indexCount);
+            for (const auto* level : levels) {
+                if (level) indices.insert(indices.end(), level->begin(), level->end());
+            }
+            part.allocation = arena.allocate(format, vertexData, vertexCount, indices.data(), indices.size());
+        }
+        return part;
     }
 };
 
 // Class to represent a 3D model composed of multiple meshes
 class Model {
-    std::vector<Mesh> meshes; // Collection of meshes in the model
+    // Meshlets handed to one culling task, small enough to balance across workers
+    static constexpr size_t MeshletsPerJob = 512;
+    // Below this many meshlets per draw culling runs inline, waking workers would cost more
+    static constexpr size_t ParallelMeshlets = 4096;
+
+    // Meshlet culling task of one frame: a run of meshlets of one part and level
+    struct MeshletJob {
+        const Mesh::Part* part = nullptr;
+        const Mesh::IndexRange* range = nullptr;
+        size_t begin = 0, end = 0;      // Meshlets of the range handled by this job
+        bool testFrustum = false;       // False when the whole mesh is inside the frustum
+        bool testCones = false;         // Whether back-facing meshlets are rejected
+        DrawBatch draws;                // Surviving index runs
+        unsigned int culled = 0;        // Meshlets rejected
+    };
+
+    std::shared_ptr<const std::vector<MeshData>> meshData; // Full-precision CPU copy, shared with background saves
+    std::vector<Mesh> meshes;       // GPU copies of meshData
+    VertexFormat format;            // Layout of the GPU copies
+    MeshArena* arena;               // Arena holding the GPU copies
+    QuantizationBox quantization;   // Position dequantization shared by all compact meshes
+    DrawBatch batch;                // Draw commands, reused every frame
+    uint64_t contentHash;           // Hash of the source file, 0 if unknown
+    Bounds bounds;                  // Object-space bounds of all meshes
+    std::vector<MeshletJob> meshletJobs; // Culling tasks, reused every frame to keep their storage
+
+    // Uploads every mesh in the current vertex format
+    void uploadMeshes() {
+        meshes.clear();
+        // One box for the whole model keeps the uniforms constant across the multi-draw
+        quantization = format == VertexFormat::Compact ? computeQuantizationBox(*meshData) : QuantizationBox();
+        meshes.reserve(meshData->size());
+        bounds = Bounds();
+        for (const auto& data : *meshData) {
+            meshes.emplace_back(data, *arena, format, quantization);
+            bounds.merge(meshes.back().bounds);
+        }
+    }
+
+    // Runs one culling task: tests its meshlets in object space against the
+    // frustum and the camera position and merges neighbouring survivors into one draw
+    void cullMeshlets(MeshletJob& job, const Frustum& frustum, const glm::vec3& camera) const {
+        job.draws.clear();
+        job.culled = 0;
+        size_t runFirst = 0, runEnd = 0;    // Current run of visible indices, relative to the range
+        for (size_t i = job.begin; i < job.end; i++) {
+            const Meshlet& meshlet = job.range->meshlets[i];
+            bool visible = !job.testFrustum || frustum.intersectsSphere(meshlet.center, meshlet.radius);
+            if (visible && job.testCones && meshlet.coneCutoff < 1.0f) {
+                // Every triangle faces away when the camera lies outside the cone's dual
+                glm::vec3 offset = meshlet.center - camera;
+                visible = glm::dot(offset, meshlet.coneAxis) < meshlet.coneCutoff * glm::length(offset) + meshlet.radius;
+            }
+            if (!visible) {
+                job.culled++;
+                continue;
+            }
+            if (meshlet.first != runEnd || runEnd == runFirst) {
+                if (runEnd > runFirst) {
+                    arena->appendDraw(job.draws, job.part->allocation, job.range->first + runFirst,
+                        static_cast<GLsizei>(runEnd - runFirst));
+                }
+                runFirst = meshlet.first;
+            }
+            runEnd = meshlet.first + meshlet.count;
+        }
+        if (runEnd > runFirst) {
+            arena->appendDraw(job.draws, job.part->allocation, job.range->first + runFirst,
+                static_cast<GLsizei>(runEnd - runFirst));
+        }
+    }
+
+    // Submits the collected batch in a single draw call
+    void submit(Shader& shader) {
+        shader.setVec3("positionOffset", quantization.offset);
+        shader.setVec3("positionScale", quantization.scale);
+        shader.setInt("octahedralNormals", format == VertexFormat::Compact ? 1 : 0);
+        arena->draw(format, batch);
+    }
+
+    // Forwards the progress of one load stage to the caller's handler, mapped
+    // into the stage's share [begin, end] of the whole load
+    class StageProgress : public Assimp::ProgressHandler {
+    private:
+        Assimp::ProgressHandler* target;
+        float begin;
+        float end;
+
+    public:
+        StageProgress(Assimp::ProgressHandler* target, float begin, float end)
+            : target(target), begin(begin), end(end) {
+        }
 
-    // Loads model from file using Assimp
-    void loadModel(const std::string& path) {
+        // Negative values only ask whether to continue and pass through unchanged
+        bool Update(float percentage) override {
+            return target->Update(percentage < 0.0f ? percentage : begin + (end - begin) * std::min(percentage, 1.0f));
+        }
+    };
+
+    // Shares of a load taken by parsing and the processing stages after it
+    static constexpr float ParseEnd = 0.5f;
+    static constexpr float OptimizeEnd = 0.6f;
+    static constexpr float LodEnd = 0.85f;
+
+    // Runs a processing stage over every mesh, work(mesh, index, stopped) returning
+    // false if it stopped. The handler (if set) gets the fraction done, mapped to
+    // [begin, end], before each mesh and is asked again through stopped inside
+    // the work, so a superseded load also stops within one large mesh. Returns
+    // false if the handler aborted the stage.
+    template <typename Work>
+    static bool runStage(std::vector<MeshData>& meshes, Assimp::ProgressHandler* progress, float begin, float end,
+        Work work) {
+        StageProgress stage(progress, begin, end);
+        std::function<bool()> stopped;
+        if (progress) {
+            stopped = [progress]() { return !progress->Update(-1.0f); };
+        }
+        for (size_t i = 0; i < meshes.size(); i++) {
+            if (progress && !stage.Update(static_cast<float>(i) / static_cast<float>(meshes.size()))) {
+                return false;
+            }
+            if (!work(meshes[i], i, stopped)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Welds and reorders a mesh and logs its cache statistics
+    static bool optimizeStage(MeshData& mesh, size_t index, const std::function<bool()>&) {
+        if (mesh.indices.size() < 3) {
+            return true;
+        }
+        MeshOptimizer::OptimizeReport report = MeshOptimizer::optimizeMesh(mesh);
+        std::cout << "Mesh " << index << ": vertices " << report.verticesBefore << " -> " << report.verticesAfter
+            << ", ACMR " << report.before.acmr << " -> " << report.after.acmr
+            << ", ATVR " << report.before.atvr << " -> " << report.after.atvr << std::endl;
+        return true;
+    }
+
+    // Builds the LOD levels of a mesh and logs their triangle counts
+    static bool lodStage(MeshData& mesh, size_t index, const std::function<bool()>& stopped) {
+        if (!MeshSimplifier::buildLods(mesh, stopped)) {
+            return false;
+        }
+        if (!mesh.lods.empty()) {
+            std::cout << "Mesh " << index << ": LOD triangles " << mesh.indices.size() / 3;
+            for (const auto& lod : mesh.lods) {
+                std::cout << " / " << lod.indices.size() / 3;
+            }
+            std::cout << ", coarsest error " << mesh.lods.back().error << std::endl;
+        }
+        return true;
+    }
+
+    // Builds the meshlets of a mesh and logs their number
+    static bool meshletStage(MeshData& mesh, size_t index, const std::function<bool()>& stopped) {
+        if (!MeshletBuilder::buildMeshlets(mesh, stopped)) {
+            return false;
+        }
+        if (!mesh.meshlets.empty()) {
+            std::cout << "Mesh " << index << ": " << mesh.meshlets.size() << " meshlets, "
+                << (mesh.closed ? "closed" : "open") << std::endl;
+        }
+        return true;
+    }
+
+    // Imports mesh data from file using Assimp
+    static std::vector<MeshData> importWithAssimp(const std::string& path, Assimp::ProgressHandler* progress) {
+        std::vector<MeshData> result;
         Assimp::Importer importer;
+        importer.SetProgressHandler(progress);
         // Import model with specified processing flags
         const aiScene* scene = importer.ReadFile(path,
             aiProcess_Triangulate | aiProcess_FlipUVs |
             aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace);
+        // Hand the caller's handler back so the importer does not delete it
+        importer.SetProgressHandler(nullptr);
 
         // Check for import errors
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-            return;
+            return result;
         }
 
         // Process each mesh in the scene
+        result.reserve(scene->mNumMeshes);
         for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
             aiMesh* mesh = scene->mMeshes[i];
-            std::vector<Vertex> vertices;
-            std::vector<unsigned int> indices;
+            MeshData data;
+            std::vector<Vertex>& vertices = data.vertices;
+            std::vector<unsigned int>& indices = data.indices;
+            vertices.reserve(mesh->mNumVertices);
+            indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
 
             // Process vertices
             for (unsigned int j = 0; j < mesh->mNumVertices; j++) {
@@ -137,91 +598,310 @@ class Model {
                 }
             }
 
-            // Add mesh to model
-            meshes.emplace_back(vertices, indices);
+            result.push_back(std::move(data));
         }
+        return result;
+    }
+
+    // Case-insensitive check of a file extension such as ".obj"
+    static bool hasExtension(const std::string& path, const char* expected) {
+        std::string extension = std::filesystem::path(path).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension == expected;
+    }
+
+    // Parses a model file with the matching reader: Draco, the built-in OBJ
+    // reader or Assimp. Parser progress covers [0, ParseEnd] of the handler.
+    // threadCount bounds the OBJ reader's threads, 0 for one per core. Returns
+    // no meshes if parsing failed or the handler aborted it.
+    static std::vector<MeshData> parseMeshData(const std::string& path, Assimp::ProgressHandler* progress,
+        unsigned int threadCount) {
+        std::vector<MeshData> meshData;
+        if (hasExtension(path, ".drc")) {
+            if (!DracoIO::read(path, meshData)) {
+                return {};
+            }
+            return meshData;
+        }
+        StageProgress parseProgress(progress, 0.0f, ParseEnd);
+        Assimp::ProgressHandler* parseHandler = progress ? &parseProgress : nullptr;
+        ObjReader::Result objResult = ObjReader::Result::Unsupported;
+        if (hasExtension(path, ".obj")) {
+            objResult = ObjReader::read(path, meshData, parseHandler, threadCount);
+        }
+        if (objResult == ObjReader::Result::Aborted) {
+            return {};
+        }
+        if (objResult == ObjReader::Result::Unsupported) {
+            meshData = importWithAssimp(path, parseHandler);
+        }
+        return meshData;
     }
 
 public:
-    // Constructor loads model from file
-    Model(const std::string& path) {
-        loadModel(path);
+    // Loads CPU-side mesh data, served from the binary mesh cache when it is up to date.
+    // Does not touch OpenGL, so it may run on a worker thread. Returns no meshes if
+    // loading failed or the progress handler aborted it; the handler is asked
+    // between stages, between meshes and inside the per-mesh work, so a
+    // superseded load stops early. The source file's content hash is stored in contentHash, 0 if it
+    // could not be determined. threadCount bounds the OBJ reader's threads, 0 for
+    // one per core.
+    static std::vector<MeshData> loadMeshData(const std::string& path, Assimp::ProgressHandler* progress = nullptr,
+        uint64_t* contentHash = nullptr, unsigned int threadCount = 0) {
+        PROFILE_SCOPE("Model::loadMeshData");
+        std::vector<MeshData> meshData;
+        if (contentHash) {
+            *contentHash = 0;
+        }
+        if (MeshCache::load(path, meshData, contentHash)) {
+            return meshData;
+        }
+        meshData = parseMeshData(path, progress, threadCount);
+        if (meshData.empty() || (progress && !progress->Update(ParseEnd))) {
+            return {};
+        }
+        // Weld, reorder, simplify and cluster once here, the cache then stores the result
+        {
+            PROFILE_SCOPE("MeshOptimizer::optimizeMeshes");
+            if (!runStage(meshData, progress, ParseEnd, OptimizeEnd, optimizeStage)) {
+                return {};
+            }
+        }
+        {
+            PROFILE_SCOPE("MeshSimplifier::buildLods");
+            if (!runStage(meshData, progress, OptimizeEnd, LodEnd, lodStage)) {
+                return {};
+            }
+        }
+        {
+            PROFILE_SCOPE("MeshletBuilder::buildMeshlets");
+            if (!runStage(meshData, progress, LodEnd, 1.0f, meshletStage)) {
+                return {};
+            }
+        }
+        if (progress && !progress->Update(1.0f)) {
+            return {};
+        }
+        if (!meshData.empty()) {
+            MeshCache::store(path, meshData, contentHash);
+        }
+        return meshData;
     }
 
-    // Draws all meshes in the model
-    void Draw(Shader& shader) const {
-        for (const auto& mesh : meshes) {
-            mesh.Draw(shader);
+    // Loads mesh data for export only: parsed and optimized, without the LOD
+    // chains and meshlets that only the renderer uses, and without touching the
+    // mesh cache unless storeInCache is set. Cache entries must be complete for
+    // the viewer, so storing runs the full loadMeshData instead. An up-to-date
+    // entry is still read. threadCount bounds the OBJ reader's threads.
+    static std::vector<MeshData> loadMeshDataForExport(const std::string& path, uint64_t* contentHash,
+        unsigned int threadCount, bool storeInCache) {
+        if (storeInCache) {
+            return loadMeshData(path, nullptr, contentHash, threadCount);
         }
+        PROFILE_SCOPE("Model::loadMeshDataForExport");
+        std::vector<MeshData> meshData;
+        if (contentHash) {
+            *contentHash = 0;
+        }
+        if (MeshCache::load(path, meshData, contentHash)) {
+            return meshData;
+        }
+        meshData = parseMeshData(path, nullptr, threadCount);
+        {
+            PROFILE_SCOPE("MeshOptimizer::optimizeMeshes");
+            runStage(meshData, nullptr, 0.0f, 1.0f, optimizeStage);
+        }
+        if (contentHash && !meshData.empty() && !MeshCache::hashFile(path, *contentHash)) {
+            *contentHash = 0;
+        }
+        return meshData;
     }
 
-    // Structure to hold bounding box information
-    struct BoundingBox {
-        glm::vec3 min; // Minimum coordinates
-        glm::vec3 max; // Maximum coordinates
-    };
+    // Constructor loads model from file into the arena
+    Model(const std::string& path, MeshArena& arena, VertexFormat format = VertexFormat::Float)
+        : format(format), arena(&arena), contentHash(0) {
+        meshData = std::make_shared<const std::vector<MeshData>>(loadMeshData(path, nullptr, &contentHash));
+        uploadMeshes();
+    }
 
-    // Calculates the bounding box of the model
-    BoundingBox getBoundingBox() const {
-        BoundingBox box;
-        box.min = glm::vec3(std::numeric_limits<float>::max());
-        box.max = glm::vec3(std::numeric_limits<float>::lowest());
+    // Constructor uploads already loaded mesh data, must run on the GL thread
+    Model(std::vector<MeshData>&& meshData, MeshArena& arena, VertexFormat format = VertexFormat::Float,
+        uint64_t contentHash = 0)
+        : meshData(std::make_shared<const std::vector<MeshData>>(std::move(meshData))), format(format), arena(&arena),
+        contentHash(contentHash) {
+        uploadMeshes();
+    }
+
+    // Models own GPU memory through their meshes and can only be moved
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
+    Model(Model&&) noexcept = default;
+    Model& operator=(Model&&) noexcept = default;
+
+    // Re-uploads all meshes in another vertex format
+    void setVertexFormat(VertexFormat newFormat) {
+        if (newFormat != format) {
+            format = newFormat;
+            uploadMeshes();
+            arena->compact();
+        }
+    }
+
+    // Getters
+    MeshArena& getArena() const { return *arena; }
+    // Immutable snapshot of the mesh data, stays valid after the model is replaced
+    std::shared_ptr<const std::vector<MeshData>> getMeshData() const { return meshData; }
+    uint64_t getContentHash() const { return contentHash; }
 
+    // Draws all meshes in the model at full detail
+    void Draw(Shader& shader) {
+        batch.clear();
         for (const auto& mesh : meshes) {
-            for (const auto& vertex : mesh.vertices) {
-                box.min = glm::min(box.min, vertex.Position);
-                box.max = glm::max(box.max, vertex.Position);
-            }
+            mesh.appendDraws(*arena, batch);
         }
-        return box;
+        submit(shader);
     }
 
-    // Saves the model to an OBJ file with applied transformation
-    void saveToOBJ(const std::string& filename, const glm::mat4& transform) const {
-        std::ofstream file(filename, std::ios::out | std::ios::binary);
-        if (!file.is_open()) {
-            return;
+    // Draws the visible parts of the meshes at the level of detail picked for the
+    // view. Meshes and then their meshlets are tested in object space against the
+    // frustum of the combined matrix, skipping the tests where a whole model or mesh
+    // is inside it; meshlets of closed meshes are also rejected when back-facing.
+    // Large meshlet counts are culled on the view's workers.
+    void Draw(Shader& shader, const LodView& view) {
+        batch.clear();
+        const Frustum frustum = Frustum::fromMatrix(view.viewProjection * view.model);
+        const Frustum::Containment containment = frustum.classify(bounds);
+        const glm::vec3 camera = glm::vec3(glm::inverse(view.model) * glm::vec4(view.cameraPosition, 1.0f));
+        unsigned int culledMeshes = 0;
+        size_t jobCount = 0, meshletCount = 0;
+        for (auto& mesh : meshes) {
+            if (mesh.parts.empty()) {
+                continue;
+            }
+            const Frustum::Containment meshContainment =
+                containment == Frustum::Containment::Intersecting ? frustum.classify(mesh.bounds) : containment;
+            if (meshContainment == Frustum::Containment::Outside) {
+                culledMeshes++;
+                continue;
+            }
+            const size_t level = mesh.selectLod(view);
+            const bool testFrustum = meshContainment == Frustum::Containment::Intersecting;
+            const bool testCones = view.backFaceCulling && (mesh.closed || view.openMeshBackFaces);
+            for (const auto& part : mesh.parts) {
+                const Mesh::IndexRange& range = part.levels[std::min(level, part.levels.size() - 1)];
+                if (range.count == 0) {
+                    continue;
+                }
+                if (range.meshlets.empty() || (!testFrustum && !testCones)) {
+                    arena->appendDraw(batch, part.allocation, range.first, range.count);
+                    continue;
+                }
+                for (size_t begin = 0; begin < range.meshlets.size(); begin += MeshletsPerJob) {
+                    if (jobCount == meshletJobs.size()) {
+                        meshletJobs.emplace_back();
+                    }
+                    MeshletJob& job = meshletJobs[jobCount++];
+                    job.part = &part;
+                    job.range = &range;
+                    job.begin = begin;
+                    job.end = std::min(begin + MeshletsPerJob, range.meshlets.size());
+                    job.testFrustum = testFrustum;
+                    job.testCones = testCones;
+                }
+                meshletCount += range.meshlets.size();
+            }
         }
 
-        file << "# Generated OBJ file\n";
-        file << std::fixed << std::setprecision(3);
+        std::function<void(size_t)> cull = [&](size_t j) { cullMeshlets(meshletJobs[j], frustum, camera); };
+        if (view.workers && meshletCount >= ParallelMeshlets) {
+            view.workers->parallelFor(jobCount, cull);
+        }
+        else {
+            for (size_t j = 0; j < jobCount; j++) {
+                cull(j);
+            }
+        }
+        unsigned int culledMeshlets = 0;
+        for (size_t j = 0; j < jobCount; j++) {
+            batch.append(meshletJobs[j].draws);
+            culledMeshlets += meshletJobs[j].culled;
+        }
+        arena->countCulled(culledMeshes, culledMeshlets);
+        submit(shader);
+    }
 
-        std::string buffer;
-        buffer.reserve(1024 * 1024);
-        unsigned int vertexOffset = 1;
+    // Draws the batch of the last Draw again with another shader, so a second pass
+    // covers exactly the same triangles, e.g. shading after a depth pre-pass
+    void redraw(Shader& shader) {
+        submit(shader);
+    }
 
+    // Structure to hold bounding box information
+    struct BoundingBox {
+        glm::vec3 min; // Minimum coordinates
+        glm::vec3 max; // Maximum coordinates
+    };
+
+    // Object-space bounds of the whole model, merged from the mesh bounds at upload
+    Bounds getBounds() const {
+        return bounds;
+    }
+
+    // Bounds of the model placed with a model matrix (e.g. HairTransform::getModelMatrix),
+    // from the mesh boxes without touching any vertex
+    Bounds getTransformedBounds(const glm::mat4& transform) const {
+        Bounds result;
         for (const auto& mesh : meshes) {
-            // Write transformed vertices
-            for (const auto& vertex : mesh.vertices) {
-                glm::vec4 transformedPos = transform * glm::vec4(vertex.Position, 1.0f);
-                buffer += "v " + std::to_string(transformedPos.x) + " " +
-                    std::to_string(transformedPos.y) + " " +
-                    std::to_string(transformedPos.z) + "\n";
-            }
+            result.merge(transformBounds(mesh.bounds, transform));
+        }
+        return result;
+    }
 
-            // Write transformed normals
-            for (const auto& vertex : mesh.vertices) {
-                glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(transform)));
-                glm::vec3 transformedNormal = glm::normalize(normalMatrix * vertex.Normal);
-                buffer += "vn " + std::to_string(transformedNormal.x) + " " +
-                    std::to_string(transformedNormal.y) + " " +
-                    std::to_string(transformedNormal.z) + "\n";
-            }
+    // Calculates the bounding box of the model
+    BoundingBox getBoundingBox() const {
+        Bounds bounds = getBounds();
+        return { bounds.min, bounds.max };
+    }
 
-            // Write faces
-            for (size_t i = 0; i < mesh.indices.size(); i += 3) {
-                buffer += "f " + std::to_string(mesh.indices[i] + vertexOffset) + "//" +
-                    std::to_string(mesh.indices[i] + vertexOffset) + " " +
-                    std::to_string(mesh.indices[i + 1] + vertexOffset) + "//" +
-                    std::to_string(mesh.indices[i + 1] + vertexOffset) + " " +
-                    std::to_string(mesh.indices[i + 2] + vertexOffset) + "//" +
-                    std::to_string(mesh.indices[i + 2] + vertexOffset) + "\n";
-            }
-            vertexOffset += static_cast<unsigned int>(mesh.vertices.size());
+    // Saves mesh data in the format given by the file extension, replacing the
+    // target atomically. Refuses models without triangles. Does not touch OpenGL,
+    // so it may run on a worker thread.
+    static bool saveMeshData(const std::vector<MeshData>& meshes, const std::string& filename,
+        const glm::mat4& transform, const SaveSettings& settings = SaveSettings(),
+        std::atomic<float>* progress = nullptr, unsigned int threadCount = 0) {
+        PROFILE_SCOPE("Model::saveMeshData");
+        // A file without geometry would replace or shadow a real one
+        if (std::none_of(meshes.begin(), meshes.end(), [](const MeshData& mesh) { return !mesh.indices.empty(); })) {
+            std::cout << "Nothing to save, the model has no triangles: " << filename << std::endl;
+            return false;
+        }
+        bool saved;
+        if (hasExtension(filename, ".drc")) {
+            saved = DracoIO::write(filename, meshes, transform, settings.draco);
         }
+        else if (hasExtension(filename, ".ply")) {
+            saved = PlyWriter::write(filename, meshes, transform, progress);
+        }
+        else if (hasExtension(filename, ".glb")) {
+            saved = GlbWriter::write(filename, meshes, transform, progress);
+        }
+        else {
+            saved = ObjWriter::write(filename, meshes, transform, settings.objPrecision, progress, threadCount);
+        }
+        if (progress) {
+            *progress = 1.0f;
+        }
+        return saved;
+    }
 
-        file.write(buffer.c_str(), buffer.size());
-        file.close();
+    // Saves the model to an OBJ file with applied transformation, through
+    // saveMeshData so the save is profiled like every other one
+    bool saveToOBJ(const std::string& filename, const glm::mat4& transform,
+        int precision = ObjWriter::DefaultPrecision) const {
+        SaveSettings settings;
+        settings.objPrecision = precision;
+        return saveMeshData(*meshData, filename, transform, settings);
     }
 };
 
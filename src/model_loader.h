@@ -0,0 +1,164 @@
+#ifndef MODEL_LOADER_H
+#define MODEL_LOADER_H
+
+#include <assimp/ProgressHandler.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mesh_data.h"
+#include "model.h"
+#include "profiler.h"
+
+// Loads models on a background thread so the render loop never waits on parsing.
+// Only the newest request matters: issuing a new one cancels the one in flight.
+// Finished mesh data is picked up on the render thread with takeResult(), which
+// is where the GPU upload and the swap happen.
+class ModelLoader {
+private:
+    // Forwards import progress and aborts loads that have been superseded
+    class Progress : public Assimp::ProgressHandler {
+        ModelLoader& loader;   // Owner receiving progress updates
+        uint64_t generation;   // Request this handler belongs to
+
+    public:
+        Progress(ModelLoader& loader, uint64_t generation)
+            : loader(loader), generation(generation) {
+        }
+
+        bool Update(float percentage) override {
+            if (percentage >= 0.0f) {
+                loader.progress = percentage;
+            }
+            return loader.generation == generation;
+        }
+    };
+
+    std::thread worker;                     // Background loading thread
+    std::mutex mutex;                       // Guards the request and result state below
+    std::condition_variable wake;           // Signals new requests or shutdown
+    std::string requestedPath;              // Path of the pending request
+    bool hasRequest;                        // Whether a request waits for the worker
+    bool stopping;                          // Set on destruction
+    std::string loadingPath;                // Path of the load in flight or pending
+    bool hasResult;                         // Whether a finished load waits for pickup
+    std::string resultPath;                 // Path of the finished load
+    std::vector<MeshData> result;           // Mesh data of the finished load
+    uint64_t resultHash;                    // Content hash of the finished load's source
+    std::atomic<uint64_t> generation;       // Incremented per request and on cancel
+    std::atomic<float> progress;            // Progress of the current load in [0, 1]
+    std::atomic<bool> busy;                 // Whether a load is pending or running
+
+public:
+    ModelLoader()
+        : hasRequest(false),
+        stopping(false),
+        hasResult(false),
+        resultHash(0),
+        generation(0),
+        progress(0.0f),
+        busy(false) {
+        worker = std::thread([this]() { run(); });
+    }
+
+    ~ModelLoader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            generation++;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    ModelLoader(const ModelLoader&) = delete;
+    ModelLoader& operator=(const ModelLoader&) = delete;
+
+    // Starts loading path, cancelling any load still in flight
+    void request(const std::string& path) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requestedPath = path;
+            loadingPath = path;
+            hasRequest = true;
+            hasResult = false;
+            result.clear();
+            progress = 0.0f;
+            busy = true;
+            generation++;
+        }
+        wake.notify_one();
+    }
+
+    // Cancels the pending or running load, the current model stays in place
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex);
+        hasRequest = false;
+        hasResult = false;
+        result.clear();
+        busy = false;
+        generation++;
+    }
+
+    // Takes a finished load, call on the render thread at a frame boundary.
+    // Returns true with empty meshes if the load failed.
+    bool takeResult(std::string& path, std::vector<MeshData>& meshes, uint64_t& contentHash) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!hasResult) {
+            return false;
+        }
+        path = std::move(resultPath);
+        meshes = std::move(result);
+        contentHash = resultHash;
+        result.clear();
+        hasResult = false;
+        return true;
+    }
+
+    // Getters
+    bool isLoading() const { return busy; }
+    float getProgress() const { return progress; }
+    std::string getLoadingPath() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return loadingPath;
+    }
+
+private:
+    // Worker loop, loads the newest request and publishes it unless superseded
+    void run() {
+        PROFILE_THREAD_NAME("Model loader");
+        while (true) {
+            std::string path;
+            uint64_t requestGeneration;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return hasRequest || stopping; });
+                if (stopping) {
+                    return;
+                }
+                path = requestedPath;
+                hasRequest = false;
+                requestGeneration = generation;
+            }
+
+            Progress handler(*this, requestGeneration);
+            uint64_t contentHash = 0;
+            std::vector<MeshData> meshes = Model::loadMeshData(path, &handler, &contentHash);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (generation != requestGeneration) {
+                continue; // Superseded or cancelled while loading
+            }
+            resultPath = path;
+            result = std::move(meshes);
+            resultHash = contentHash;
+            hasResult = true;
+            busy = false;
+        }
+    }
+};
+
+#endif
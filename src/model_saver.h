@@ -0,0 +1,143 @@
+#ifndef MODEL_SAVER_H
+#define MODEL_SAVER_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mesh_data.h"
+#include "model.h"
+#include "profiler.h"
+
+// Saves models on a background thread so the render loop never waits on
+// formatting or disk I/O. A request snapshots everything it needs (shared mesh
+// data, matrix, settings), so the model may be edited or replaced meanwhile.
+// Files are replaced atomically, a crash mid-save leaves the old file intact.
+class ModelSaver {
+private:
+    // Everything a save needs, captured at request time
+    struct Job {
+        std::shared_ptr<const std::vector<MeshData>> meshes; // Snapshot of the model's mesh data
+        std::string path;                                     // Target file
+        glm::mat4 transform;                                  // Baked into the written vertices
+        SaveSettings settings;                                // Output settings
+    };
+
+    std::thread worker;                 // Background saving thread
+    std::mutex mutex;                   // Guards the job and result state below
+    std::condition_variable wake;       // Signals new jobs or shutdown
+    // Outcome of a finished save
+    struct Result {
+        std::string path;
+        bool ok;
+    };
+
+    std::deque<Job> pending;            // Jobs waiting for the worker, at most one per path
+    bool stopping;                      // Set on destruction
+    std::string savingPath;             // Path of the save in flight or next in line
+    std::deque<Result> results;         // Finished saves waiting for pickup, oldest first
+    std::atomic<float> progress;        // Progress of the current save in [0, 1]
+    std::atomic<bool> busy;             // Whether a save is pending or running
+
+public:
+    ModelSaver()
+        : stopping(false),
+        progress(0.0f),
+        busy(false) {
+        worker = std::thread([this]() { run(); });
+    }
+
+    // Finishes the running and pending saves before returning, so quitting
+    // right after pressing save does not lose the file
+    ~ModelSaver() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    ModelSaver(const ModelSaver&) = delete;
+    ModelSaver& operator=(const ModelSaver&) = delete;
+
+    // Queues a save. A save of the same path still waiting for the worker is
+    // replaced, one that already runs completes first; saves of other paths
+    // (e.g. exports to several formats) all run, in request order.
+    void request(std::shared_ptr<const std::vector<MeshData>> meshes, const std::string& path,
+        const glm::mat4& transform, const SaveSettings& settings) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Job job{ std::move(meshes), path, transform, settings };
+            auto same = std::find_if(pending.begin(), pending.end(), [&](const Job& queued) { return queued.path == path; });
+            if (same != pending.end()) {
+                *same = std::move(job);
+            }
+            else {
+                pending.push_back(std::move(job));
+            }
+            if (!busy) {
+                savingPath = path;
+            }
+            busy = true;
+        }
+        wake.notify_one();
+    }
+
+    // Takes the outcome of the oldest finished save, call from the UI thread
+    bool takeResult(std::string& path, bool& ok) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (results.empty()) {
+            return false;
+        }
+        path = std::move(results.front().path);
+        ok = results.front().ok;
+        results.pop_front();
+        return true;
+    }
+
+    // Getters
+    bool isSaving() const { return busy; }
+    float getProgress() const { return progress; }
+    std::string getSavingPath() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return savingPath;
+    }
+
+private:
+    // Worker loop, runs jobs until stopped and nothing is pending
+    void run() {
+        PROFILE_THREAD_NAME("Model saver");
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return !pending.empty() || stopping; });
+                if (pending.empty()) {
+                    return;
+                }
+                job = std::move(pending.front());
+                pending.pop_front();
+                savingPath = job.path;
+                progress = 0.0f;
+            }
+
+            // Leave one core to the render thread so frames keep their pace
+            unsigned int threads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+            bool ok = Model::saveMeshData(*job.meshes, job.path, job.transform, job.settings, &progress,
+                std::max(1u, threads));
+
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back({ job.path, ok });
+            busy = !pending.empty();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,437 @@
+#ifndef OBJ_READER_H
+#define OBJ_READER_H
+
+#include <glm/glm.hpp>
+#include <assimp/ProgressHandler.hpp>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "mesh_data.h"
+#include "mapped_file.h"
+
+// Multithreaded reader for plain triangle/polygon OBJ files.
+// The file is memory-mapped and split into line-aligned chunks. A first
+// parallel pass counts records per chunk, a second pass parses them straight
+// into the final arrays at their prefix offsets. Every o/g group with faces
+// becomes its own mesh, as with Assimp. Files using anything beyond v/vn/vt/f
+// records (lines, curves, negative indices, ...) are rejected so the caller can
+// fall back to Assimp.
+class ObjReader {
+public:
+    // Outcome of a read
+    enum class Result {
+        Ok,          // Meshes were read
+        Unsupported, // File needs the Assimp importer
+        Aborted      // Progress handler requested cancellation
+    };
+
+private:
+    static constexpr unsigned int NoIndex = 0xFFFFFFFFu;
+    static constexpr size_t MinChunkSize = 1024 * 1024;
+
+    // Byte range of a chunk and the number of records it holds
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        size_t positionCount = 0;
+        size_t normalCount = 0;
+        size_t cornerCount = 0;   // Triangulated face corners
+        std::vector<size_t> groupStarts; // Corners in the chunk before each o/g statement
+        bool supported = true;
+    };
+
+    // Record type of a line, decided from its leading keyword
+    enum class LineType { Ignored, Position, Normal, Face, Group, Unsupported };
+
+public:
+    // Reads an OBJ file into one mesh per group. Progress is reported from the
+    // calling thread only, between passes.
+    static Result read(const std::string& path, std::vector<MeshData>& meshes,
+        Assimp::ProgressHandler* progress = nullptr, unsigned int threadCount = 0) {
+        MappedFile file;
+        if (!file.open(path)) {
+            return Result::Unsupported;
+        }
+        if (progress && !progress->Update(0.05f)) {
+            return Result::Aborted;
+        }
+        const char* data = reinterpret_cast<const char*>(file.data());
+        size_t size = file.size();
+
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        std::vector<Chunk> chunks = splitChunks(data, size, threadCount);
+
+        // Pass 1: count records so every chunk knows where its output goes
+        forEachChunk(chunks, [](Chunk& chunk) { countChunk(chunk); });
+        for (const auto& chunk : chunks) {
+            if (!chunk.supported) {
+                return Result::Unsupported;
+            }
+        }
+        if (progress && !progress->Update(0.2f)) {
+            return Result::Aborted;
+        }
+
+        std::vector<size_t> positionOffsets(chunks.size()), normalOffsets(chunks.size()), cornerOffsets(chunks.size());
+        size_t positionTotal = 0, normalTotal = 0, cornerTotal = 0;
+        std::vector<size_t> groupStarts;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            positionOffsets[i] = positionTotal;
+            normalOffsets[i] = normalTotal;
+            cornerOffsets[i] = cornerTotal;
+            for (size_t start : chunks[i].groupStarts) {
+                groupStarts.push_back(cornerTotal + start);
+            }
+            positionTotal += chunks[i].positionCount;
+            normalTotal += chunks[i].normalCount;
+            cornerTotal += chunks[i].cornerCount;
+        }
+        if (positionTotal == 0 || cornerTotal == 0 || positionTotal >= NoIndex || normalTotal >= NoIndex) {
+            return Result::Unsupported;
+        }
+
+        // Pass 2: parse positions into the vertex array and faces into index arrays
+        MeshData mesh;
+        mesh.vertices.resize(positionTotal);
+        mesh.indices.resize(cornerTotal);
+        std::vector<glm::vec3> normals(normalTotal);
+        std::vector<unsigned int> normalIndices(cornerTotal);
+        std::atomic<bool> valid(true);
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            auto job = [&, i]() {
+                if (!parseChunk(chunks[i], mesh.vertices.data() + positionOffsets[i], normals.data() + normalOffsets[i],
+                    mesh.indices.data() + cornerOffsets[i], normalIndices.data() + cornerOffsets[i],
+                    positionTotal, normalTotal)) {
+                    valid = false;
+                }
+            };
+            if (i + 1 == chunks.size()) job();
+            else workers.emplace_back(job);
+        }
+        for (auto& worker : workers) worker.join();
+        if (!valid) {
+            return Result::Unsupported;
+        }
+        if (progress && !progress->Update(0.8f)) {
+            return Result::Aborted;
+        }
+
+        if (!resolveNormals(mesh, normals, normalIndices)) {
+            return Result::Unsupported;
+        }
+        meshes.clear();
+        splitGroups(mesh, groupStarts, meshes);
+        if (progress) {
+            progress->Update(1.0f);
+        }
+        return Result::Ok;
+    }
+
+private:
+    // Splits the buffer into roughly equal chunks that end on line boundaries
+    static std::vector<Chunk> splitChunks(const char* data, size_t size, unsigned int threadCount) {
+        size_t count = std::max<size_t>(1, std::min<size_t>(threadCount, size / MinChunkSize));
+        std::vector<Chunk> chunks;
+        const char* begin = data;
+        const char* end = data + size;
+        for (size_t i = 0; i < count && begin < end; i++) {
+            const char* split = (i + 1 == count) ? end : std::min(end, data + size * (i + 1) / count);
+            if (split < end) {
+                const void* newline = std::memchr(split, '\n', end - split);
+                split = newline ? static_cast<const char*>(newline) + 1 : end;
+            }
+            if (split <= begin) continue;
+            Chunk chunk;
+            chunk.begin = begin;
+            chunk.end = split;
+            chunks.push_back(chunk);
+            begin = split;
+        }
+        return chunks;
+    }
+
+    // Runs a job for every chunk, one thread per chunk
+    template <typename Job>
+    static void forEachChunk(std::vector<Chunk>& chunks, Job job) {
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i + 1 < chunks.size(); i++) {
+            workers.emplace_back([&chunks, &job, i]() { job(chunks[i]); });
+        }
+        if (!chunks.empty()) job(chunks.back());
+        for (auto& worker : workers) worker.join();
+    }
+
+    // Finds the end of the line starting at p
+    static const char* lineEnd(const char* p, const char* end) {
+        const void* newline = std::memchr(p, '\n', end - p);
+        return newline ? static_cast<const char*>(newline) : end;
+    }
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    static const char* skipSpaces(const char* p, const char* end) {
+        while (p < end && isSpace(*p)) p++;
+        return p;
+    }
+
+    // Classifies a line and advances p past its keyword
+    static LineType classify(const char*& p, const char* end) {
+        p = skipSpaces(p, end);
+        if (p >= end || *p == '#') return LineType::Ignored;
+        const char* keyword = p;
+        while (p < end && !isSpace(*p)) p++;
+        size_t length = p - keyword;
+
+        if (length == 1 && keyword[0] == 'v') return LineType::Position;
+        if (length == 1 && keyword[0] == 'f') return LineType::Face;
+        if (length == 2 && keyword[0] == 'v' && keyword[1] == 'n') return LineType::Normal;
+        if (length == 1 && (keyword[0] == 'o' || keyword[0] == 'g')) return LineType::Group;
+        // Texture coordinates, smoothing and material statements carry nothing we render
+        if ((length == 2 && keyword[0] == 'v' && (keyword[1] == 't' || keyword[1] == 'p')) ||
+            (length == 1 && keyword[0] == 's') ||
+            (length == 6 && std::memcmp(keyword, "usemtl", 6) == 0) ||
+            (length == 6 && std::memcmp(keyword, "mtllib", 6) == 0)) {
+            return LineType::Ignored;
+        }
+        return LineType::Unsupported;
+    }
+
+    // Counts face vertices on a face line
+    static size_t countFaceCorners(const char* p, const char* end) {
+        size_t corners = 0;
+        while (true) {
+            p = skipSpaces(p, end);
+            if (p >= end) break;
+            corners++;
+            while (p < end && !isSpace(*p)) p++;
+        }
+        return corners;
+    }
+
+    // Pass 1: counts records in a chunk and flags unsupported content
+    static void countChunk(Chunk& chunk) {
+        const char* p = chunk.begin;
+        while (p < chunk.end) {
+            const char* end = lineEnd(p, chunk.end);
+            if (end > p && end[-1] == '\\') {
+                chunk.supported = false; // Line continuations
+                return;
+            }
+            switch (classify(p, end)) {
+            case LineType::Position: chunk.positionCount++; break;
+            case LineType::Normal: chunk.normalCount++; break;
+            case LineType::Face: {
+                size_t corners = countFaceCorners(p, end);
+                if (corners < 3) {
+                    chunk.supported = false;
+                    return;
+                }
+                chunk.cornerCount += (corners - 2) * 3;
+                break;
+            }
+            case LineType::Group: chunk.groupStarts.push_back(chunk.cornerCount); break;
+            case LineType::Unsupported:
+                chunk.supported = false;
+                return;
+            default:
+                break;
+            }
+            p = end + 1;
+        }
+    }
+
+    // Parses a float, accepting an optional leading '+'
+    static bool parseFloat(const char*& p, const char* end, float& value) {
+        p = skipSpaces(p, end);
+        if (p < end && *p == '+') p++;
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc()) return false;
+        p = result.ptr;
+        return true;
+    }
+
+    // Parses an unsigned 1-based index, returns false if none is present or it overflows
+    static bool parseIndex(const char*& p, const char* end, unsigned int& value) {
+        value = 0;
+        if (p >= end || *p < '0' || *p > '9') return false;
+        uint64_t parsed = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            parsed = parsed * 10 + static_cast<uint64_t>(*p - '0');
+            if (parsed >= NoIndex) return false;
+            p++;
+        }
+        value = static_cast<unsigned int>(parsed);
+        return true;
+    }
+
+    // Parses one v, v/vt, v//vn or v/vt/vn face vertex into 0-based indices
+    static bool parseCorner(const char*& p, const char* end, unsigned int& position, unsigned int& normal) {
+        unsigned int value;
+        if (!parseIndex(p, end, value) || value == 0) return false;
+        position = value - 1;
+        normal = NoIndex;
+        if (p < end && *p == '/') {
+            p++;
+            if (p < end && *p != '/') {
+                if (!parseIndex(p, end, value)) return false; // Texture coordinate, ignored
+            }
+            if (p < end && *p == '/') {
+                p++;
+                if (!parseIndex(p, end, value) || value == 0) return false;
+                normal = value - 1;
+            }
+        }
+        return p >= end || isSpace(*p);
+    }
+
+    // Pass 2: parses a chunk into its slices of the output arrays
+    static bool parseChunk(const Chunk& chunk, Vertex* vertices, glm::vec3* normals,
+        unsigned int* indices, unsigned int* normalIndices, size_t positionTotal, size_t normalTotal) {
+        const char* p = chunk.begin;
+        while (p < chunk.end) {
+            const char* end = lineEnd(p, chunk.end);
+            switch (classify(p, end)) {
+            case LineType::Position: {
+                glm::vec3& position = (vertices++)->Position;
+                if (!parseFloat(p, end, position.x) || !parseFloat(p, end, position.y) ||
+                    !parseFloat(p, end, position.z)) {
+                    return false;
+                }
+                break;
+            }
+            case LineType::Normal: {
+                glm::vec3& normal = *normals++;
+                if (!parseFloat(p, end, normal.x) || !parseFloat(p, end, normal.y) ||
+                    !parseFloat(p, end, normal.z)) {
+                    return false;
+                }
+                break;
+            }
+            case LineType::Face: {
+                // Fan-triangulate polygons as they are read
+                unsigned int firstPosition = 0, firstNormal = 0, lastPosition = 0, lastNormal = 0;
+                size_t corner = 0;
+                while (true) {
+                    p = skipSpaces(p, end);
+                    if (p >= end) break;
+                    unsigned int position, normal;
+                    if (!parseCorner(p, end, position, normal) || position >= positionTotal ||
+                        (normal != NoIndex && normal >= normalTotal)) {
+                        return false;
+                    }
+                    if (corner == 0) {
+                        firstPosition = position;
+                        firstNormal = normal;
+                    }
+                    else if (corner >= 2) {
+                        *indices++ = firstPosition;
+                        *indices++ = lastPosition;
+                        *indices++ = position;
+                        *normalIndices++ = firstNormal;
+                        *normalIndices++ = lastNormal;
+                        *normalIndices++ = normal;
+                    }
+                    lastPosition = position;
+                    lastNormal = normal;
+                    corner++;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+            p = end + 1;
+        }
+        return true;
+    }
+
+    // Splits the parsed mesh at the given corner offsets into meshes holding only
+    // the vertices they use. Groups without faces are dropped, a file with a
+    // single group keeps its mesh as parsed.
+    static void splitGroups(MeshData& mesh, std::vector<size_t> starts, std::vector<MeshData>& meshes) {
+        starts.push_back(0);
+        starts.push_back(mesh.indices.size());
+        std::sort(starts.begin(), starts.end());
+        starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+        if (starts.size() <= 2) {
+            meshes.push_back(std::move(mesh));
+            return;
+        }
+        std::vector<unsigned int> local(mesh.vertices.size(), NoIndex);
+        std::vector<unsigned int> used;
+        for (size_t g = 0; g + 1 < starts.size(); g++) {
+            MeshData group;
+            group.indices.reserve(starts[g + 1] - starts[g]);
+            for (size_t i = starts[g]; i < starts[g + 1]; i++) {
+                unsigned int& index = local[mesh.indices[i]];
+                if (index == NoIndex) {
+                    index = static_cast<unsigned int>(group.vertices.size());
+                    group.vertices.push_back(mesh.vertices[mesh.indices[i]]);
+                    used.push_back(mesh.indices[i]);
+                }
+                group.indices.push_back(index);
+            }
+            for (unsigned int vertex : used) {
+                local[vertex] = NoIndex;
+            }
+            used.clear();
+            meshes.push_back(std::move(group));
+        }
+    }
+
+    // Turns per-corner normal references into the final vertex layout
+    static bool resolveNormals(MeshData& mesh, const std::vector<glm::vec3>& normals,
+        const std::vector<unsigned int>& normalIndices) {
+        size_t withNormals = std::count_if(normalIndices.begin(), normalIndices.end(),
+            [](unsigned int n) { return n != NoIndex; });
+
+        if (withNormals == 0) {
+            computeSmoothNormals(mesh);
+            return true;
+        }
+        if (withNormals != normalIndices.size()) {
+            return false; // Mixed faces with and without normals
+        }
+
+        // Common case for exported meshes: every face uses the same index for v and vn
+        if (normals.size() == mesh.vertices.size() &&
+            std::equal(mesh.indices.begin(), mesh.indices.end(), normalIndices.begin())) {
+            for (size_t i = 0; i < normals.size(); i++) {
+                mesh.vertices[i].Normal = validNormal(normals[i]);
+            }
+            return true;
+        }
+
+        // General case: one vertex per unique position/normal pair
+        std::vector<Vertex> vertices;
+        vertices.reserve(mesh.vertices.size());
+        std::unordered_map<uint64_t, unsigned int> remap;
+        remap.reserve(mesh.vertices.size());
+        for (size_t i = 0; i < mesh.indices.size(); i++) {
+            uint64_t key = (static_cast<uint64_t>(mesh.indices[i]) << 32) | normalIndices[i];
+            auto inserted = remap.emplace(key, static_cast<unsigned int>(vertices.size()));
+            if (inserted.second) {
+                Vertex vertex;
+                vertex.Position = mesh.vertices[mesh.indices[i]].Position;
+                vertex.Normal = validNormal(normals[normalIndices[i]]);
+                vertices.push_back(vertex);
+            }
+            mesh.indices[i] = inserted.first->second;
+        }
+        mesh.vertices = std::move(vertices);
+        return true;
+    }
+};
+
+#endif
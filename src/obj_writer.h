@@ -0,0 +1,153 @@
+#ifndef OBJ_WRITER_H
+#define OBJ_WRITER_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mesh_data.h"
+#include "atomic_file.h"
+
+// Multithreaded OBJ exporter. Vertices, normals and faces are cut into
+// fixed-size chunks that worker threads format with std::to_chars into their
+// own buffers; the buffers are then joined and written with a single write
+// that atomically replaces the target file.
+class ObjWriter {
+public:
+    // Decimals written per coordinate, what the previous exporter produced
+    static constexpr int DefaultPrecision = 6;
+    static constexpr int MaxPrecision = 9;
+
+private:
+    // Elements (vertices or triangles) formatted per chunk
+    static constexpr size_t ChunkElements = 1 << 16;
+
+    // Which record type a chunk produces
+    enum class Section { Positions, Normals, Faces };
+
+    // One unit of formatting work and its output
+    struct Chunk {
+        const MeshData* mesh;
+        Section section;
+        size_t begin, end;          // Element range within the mesh
+        unsigned int vertexOffset;  // 1-based index of the mesh's first vertex in the file
+        std::string text;
+    };
+
+public:
+    // Writes all meshes with the transform applied to positions and normals.
+    // Returns false if the file cannot be written, the old file then stays intact.
+    static bool write(const std::string& path, const std::vector<MeshData>& meshes, const glm::mat4& transform,
+        int precision = DefaultPrecision, std::atomic<float>* progress = nullptr, unsigned int threadCount = 0) {
+        std::string output = format(meshes, transform, precision, progress, threadCount);
+        return AtomicFile::write(path, output.data(), output.size());
+    }
+
+    // Formats all meshes into OBJ text. Progress, if given, is the fraction of
+    // formatted chunks and may be read from other threads.
+    static std::string format(const std::vector<MeshData>& meshes, const glm::mat4& transform,
+        int precision = DefaultPrecision, std::atomic<float>* progress = nullptr, unsigned int threadCount = 0) {
+        precision = std::clamp(precision, 0, MaxPrecision);
+        const glm::mat3 normalTransform = normalMatrix(transform);
+
+        // Same record order as before: per mesh all v, then all vn, then all f
+        std::vector<Chunk> chunks;
+        unsigned int vertexOffset = 1;
+        for (const auto& mesh : meshes) {
+            const size_t triangleCount = mesh.indices.size() / 3;
+            for (Section section : { Section::Positions, Section::Normals, Section::Faces }) {
+                size_t count = section == Section::Faces ? triangleCount : mesh.vertices.size();
+                for (size_t begin = 0; begin < count; begin += ChunkElements) {
+                    chunks.push_back({ &mesh, section, begin, std::min(count, begin + ChunkElements), vertexOffset, {} });
+                }
+            }
+            vertexOffset += static_cast<unsigned int>(mesh.vertices.size());
+        }
+
+        // Workers take chunks in order from a shared counter
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, std::max<size_t>(1, chunks.size())));
+        std::atomic<size_t> next(0), done(0);
+        auto work = [&]() {
+            for (size_t i = next++; i < chunks.size(); i = next++) {
+                formatChunk(chunks[i], transform, normalTransform, precision);
+                size_t finished = ++done;
+                if (progress) {
+                    *progress = static_cast<float>(finished) / static_cast<float>(chunks.size());
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned int t = 1; t < threadCount; t++) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) worker.join();
+
+        static const char header[] = "# Generated OBJ file\n";
+        size_t total = sizeof(header) - 1;
+        for (const auto& chunk : chunks) {
+            total += chunk.text.size();
+        }
+        std::string output;
+        output.reserve(total);
+        output.append(header, sizeof(header) - 1);
+        for (auto& chunk : chunks) {
+            output += chunk.text;
+            std::string().swap(chunk.text);
+        }
+        return output;
+    }
+
+private:
+    // Formats the records of one chunk
+    static void formatChunk(Chunk& chunk, const glm::mat4& transform, const glm::mat3& normalTransform, int precision) {
+        const MeshData& mesh = *chunk.mesh;
+        const size_t count = chunk.end - chunk.begin;
+        // Worst case per line: fixed notation of FLT_MAX has 39 integer digits
+        const size_t floatChars = 1 + 39 + 1 + static_cast<size_t>(precision);
+        const size_t lineChars = chunk.section == Section::Faces ? 2 + 3 * (10 + 2 + 10 + 1) : 3 + 3 * (floatChars + 1);
+        chunk.text.resize(count * lineChars);
+        char* out = chunk.text.data();
+        char* const end = out + chunk.text.size();
+
+        if (chunk.section == Section::Faces) {
+            for (size_t t = chunk.begin; t < chunk.end; t++) {
+                *out++ = 'f';
+                for (int k = 0; k < 3; k++) {
+                    unsigned int index = mesh.indices[t * 3 + k] + chunk.vertexOffset;
+                    *out++ = ' ';
+                    out = std::to_chars(out, end, index).ptr;
+                    *out++ = '/';
+                    *out++ = '/';
+                    out = std::to_chars(out, end, index).ptr;
+                }
+                *out++ = '\n';
+            }
+        }
+        else {
+            const bool positions = chunk.section == Section::Positions;
+            for (size_t v = chunk.begin; v < chunk.end; v++) {
+                glm::vec3 value = positions
+                    ? glm::vec3(transform * glm::vec4(mesh.vertices[v].Position, 1.0f))
+                    : glm::normalize(normalTransform * mesh.vertices[v].Normal);
+                *out++ = 'v';
+                if (!positions) *out++ = 'n';
+                for (int k = 0; k < 3; k++) {
+                    *out++ = ' ';
+                    out = std::to_chars(out, end, value[k], std::chars_format::fixed, precision).ptr;
+                }
+                *out++ = '\n';
+            }
+        }
+        chunk.text.resize(out - chunk.text.data());
+    }
+};
+
+#endif
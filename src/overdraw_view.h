@@ -0,0 +1,274 @@
+#ifndef OVERDRAW_VIEW_H
+#define OVERDRAW_VIEW_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include "gl_diagnostics.h"
+#include "gl_handle.h"
+#include "shader.h"
+
+// Overdraw debug view. The head and hair are drawn into a two-channel float
+// framebuffer with additive blending and the depth test off, so every pixel
+// ends up holding how many fragments of each model were rasterized on it (its
+// depth complexity). The counts are shown as a heat map and read back through
+// pixel buffers a few frames later, without stalling, for the average and
+// maximum per model.
+class OverdrawView {
+public:
+    // Models counted and shown, usable as a bit mask
+    enum class Layer { Head = 1, Hair = 2, Both = 3 };
+
+    // Depth complexity of one model in a measured frame
+    struct Complexity {
+        uint32_t coveredPixels = 0; // Pixels at least one fragment reached
+        uint64_t fragments = 0;     // Fragments over all pixels
+        uint32_t maximum = 0;       // Most fragments on one pixel
+
+        // Mean fragments per covered pixel
+        float average() const {
+            return coveredPixels > 0 ? static_cast<float>(fragments) / static_cast<float>(coveredPixels) : 0.0f;
+        }
+    };
+
+    // Frames a readback is in flight before it is read
+    static constexpr int Latency = 3;
+
+private:
+    // Pixel buffer receiving the counts of one frame
+    struct Readback {
+        GLBuffer buffer;
+        GLsync fence = nullptr;     // Signals the copy finished, null when not in flight
+        int width = 0;
+        int height = 0;
+        size_t capacity = 0;        // Bytes allocated for the buffer
+    };
+
+    Shader countShader;             // Adds one to the model's channel per fragment
+    Shader heatShader;              // Maps counts to colours over the viewport
+    GLTexture counts;               // RG32F, head in red, hair in green
+    GLFramebuffer framebuffer;
+    GLVertexArray emptyVertexArray; // Core profile draws need one bound, even without attributes
+    std::array<Readback, Latency> readbacks;
+    int nextReadback;               // Slot the next copy goes to
+    int width;                      // Size of the count texture
+    int height;
+    bool complete;                  // Whether the framebuffer can be rendered to
+    Layer shown;                    // Counts shown in the heat map
+    int heatScale;                  // Count shown as the hottest colour
+    Complexity head;                // Latest measured complexities
+    Complexity hair;
+    int measuredWidth;              // Size of the latest measured frame, 0 before the first
+    int measuredHeight;
+
+public:
+    // Builds the programs from the model vertex shader and the overdraw shaders
+    OverdrawView(const char* vertexPath, const char* countFragmentPath,
+        const char* screenVertexPath, const char* heatFragmentPath)
+        : countShader(vertexPath, countFragmentPath),
+        heatShader(screenVertexPath, heatFragmentPath),
+        counts(GLTexture::create()),
+        framebuffer(GLFramebuffer::create()),
+        emptyVertexArray(GLVertexArray::create()),
+        nextReadback(0),
+        width(0),
+        height(0),
+        complete(false),
+        shown(Layer::Both),
+        heatScale(8),
+        measuredWidth(0),
+        measuredHeight(0) {
+        GLDiagnostics::label(GL_PROGRAM, countShader.ID, "Overdraw count shader");
+        GLDiagnostics::label(GL_PROGRAM, heatShader.ID, "Overdraw heat map shader");
+        for (auto& readback : readbacks) {
+            readback.buffer = GLBuffer::create();
+        }
+    }
+
+    ~OverdrawView() {
+        for (auto& readback : readbacks) {
+            if (readback.fence) {
+                glDeleteSync(readback.fence);
+            }
+        }
+    }
+
+    OverdrawView(const OverdrawView&) = delete;
+    OverdrawView& operator=(const OverdrawView&) = delete;
+
+    // Returns the counting program, the FrameData block still has to be attached
+    Shader& getCountShader() { return countShader; }
+
+    // Collects finished readbacks, then binds and clears the count framebuffer at
+    // the given size with blending set up for counting. Returns false if nothing
+    // can be counted (minimized window or unsupported framebuffer).
+    bool begin(int framebufferWidth, int framebufferHeight) {
+        collectReadbacks();
+        if (framebufferWidth <= 0 || framebufferHeight <= 0 || !resize(framebufferWidth, framebufferHeight)) {
+            return false;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+        countShader.use();
+        return true;
+    }
+
+    // Routes the following draws to a model's channel and returns the counting
+    // program for setting the model matrix
+    Shader& countLayer(Layer layer) {
+        countShader.setVec3("channel", layer == Layer::Head ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+        return countShader;
+    }
+
+    // Queues the readback of the counts, restores the default framebuffer and
+    // render state, and draws the heat map over the whole viewport
+    void end() {
+        queueReadback();
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDisable(GL_BLEND);
+
+        // The fullscreen triangle must be filled even in wireframe mode
+        GLint polygonMode[2];
+        glGetIntegerv(GL_POLYGON_MODE, polygonMode);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        heatShader.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, counts.get());
+        heatShader.setInt("counts", 0);
+        heatShader.setInt("layers", static_cast<int>(shown));
+        heatShader.setInt("heatScale", heatScale);
+        glBindVertexArray(emptyVertexArray.get());
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glPolygonMode(GL_FRONT_AND_BACK, static_cast<GLenum>(polygonMode[0]));
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    // Whether a readback is still in flight, frames must keep coming to collect it
+    bool isReadbackPending() const {
+        for (const auto& readback : readbacks) {
+            if (readback.fence) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Setters
+    void setShown(Layer layer) { shown = layer; }
+    void setHeatScale(int scale) { heatScale = std::max(1, scale); }
+
+    // Getters
+    Layer getShown() const { return shown; }
+    int getHeatScale() const { return heatScale; }
+    const Complexity& getHead() const { return head; }
+    const Complexity& getHair() const { return hair; }
+    // Whether any frame has been measured yet
+    bool hasMeasurement() const { return measuredWidth > 0; }
+    int getMeasuredPixels() const { return measuredWidth * measuredHeight; }
+
+private:
+    // Reallocates the count texture for a new size, returns false if the
+    // framebuffer is incomplete (e.g. no float render targets)
+    bool resize(int newWidth, int newHeight) {
+        if (newWidth == width && newHeight == height) {
+            return complete;
+        }
+        width = newWidth;
+        height = newHeight;
+        glBindTexture(GL_TEXTURE_2D, counts.get());
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, width, height, 0, GL_RG, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        GLDiagnostics::label(GL_TEXTURE, counts.get(), "Overdraw counts");
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, counts.get(), 0);
+        complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLDiagnostics::label(GL_FRAMEBUFFER, framebuffer.get(), "Overdraw framebuffer");
+        if (!complete) {
+            std::cout << "Overdraw view: float framebuffer not supported" << std::endl;
+        }
+        return complete;
+    }
+
+    // Starts copying the counts into the next free pixel buffer; skipped when
+    // all are still in flight
+    void queueReadback() {
+        Readback& readback = readbacks[nextReadback];
+        if (readback.fence) {
+            return;
+        }
+        const size_t bytes = static_cast<size_t>(width) * static_cast<size_t>(height) * 2 * sizeof(float);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.get());
+        if (readback.capacity != bytes) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_READ);
+            readback.capacity = bytes;
+        }
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glReadPixels(0, 0, width, height, GL_RG, GL_FLOAT, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        readback.width = width;
+        readback.height = height;
+        nextReadback = (nextReadback + 1) % Latency;
+    }
+
+    // Measures every finished readback, oldest first, so the newest result wins
+    void collectReadbacks() {
+        for (int i = 0; i < Latency; i++) {
+            Readback& readback = readbacks[(nextReadback + i) % Latency];
+            if (!readback.fence) {
+                continue;
+            }
+            GLenum status = glClientWaitSync(readback.fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                break;
+            }
+            glDeleteSync(readback.fence);
+            readback.fence = nullptr;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.get());
+            const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(readback.capacity), GL_MAP_READ_BIT);
+            if (data) {
+                measure(static_cast<const float*>(data), readback.width, readback.height);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+    }
+
+    // Computes the complexity of both models from interleaved head and hair counts
+    void measure(const float* pixels, int pixelsWidth, int pixelsHeight) {
+        head = Complexity();
+        hair = Complexity();
+        const size_t count = static_cast<size_t>(pixelsWidth) * static_cast<size_t>(pixelsHeight);
+        for (size_t i = 0; i < count; i++) {
+            accumulate(head, pixels[i * 2]);
+            accumulate(hair, pixels[i * 2 + 1]);
+        }
+        measuredWidth = pixelsWidth;
+        measuredHeight = pixelsHeight;
+    }
+
+    static void accumulate(Complexity& complexity, float value) {
+        // Counts are whole numbers, exact in floats up to 2^24
+        const uint32_t fragments = static_cast<uint32_t>(value + 0.5f);
+        if (fragments == 0) {
+            return;
+        }
+        complexity.coveredPixels++;
+        complexity.fragments += fragments;
+        complexity.maximum = std::max(complexity.maximum, fragments);
+    }
+};
+
+#endif
@@ -0,0 +1,299 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <glad/glad.h>
+#include <imgui.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "gl_handle.h"
+#include "mesh_arena.h"
+
+// Rolling window of durations in milliseconds for one measured section
+class TimingSeries {
+public:
+    static constexpr size_t Capacity = 240; // Four seconds at 60 fps
+
+private:
+    std::array<float, Capacity> samples;    // Ring buffer
+    size_t next;                            // Slot the next sample goes to
+    size_t count;                           // Valid samples, at most Capacity
+
+public:
+    TimingSeries() : samples(), next(0), count(0) {}
+
+    // Adds a sample, dropping the oldest once the window is full
+    void add(float milliseconds) {
+        samples[next] = milliseconds;
+        next = (next + 1) % Capacity;
+        count = std::min(count + 1, Capacity);
+    }
+
+    // Mean over the window, 0 when empty
+    float average() const {
+        float sum = 0.0f;
+        for (size_t i = 0; i < count; i++) {
+            sum += samples[i];
+        }
+        return count > 0 ? sum / static_cast<float>(count) : 0.0f;
+    }
+
+    // Value below which the given fraction of the window lies, 0 when empty
+    float percentile(float fraction, std::vector<float>& scratch) const {
+        if (count == 0) {
+            return 0.0f;
+        }
+        scratch.assign(samples.begin(), samples.begin() + count);
+        size_t rank = std::min(count - 1, static_cast<size_t>(fraction * static_cast<float>(count)));
+        std::nth_element(scratch.begin(), scratch.begin() + rank, scratch.end());
+        return scratch[rank];
+    }
+
+    // Getters
+    const float* data() const { return samples.data(); }
+    size_t size() const { return count; }
+    // Index of the oldest sample in data(), for plotting in order
+    size_t oldest() const { return count < Capacity ? 0 : next; }
+};
+
+// Frame profiling: CPU sections timed with scoped timers, GPU passes timed with
+// GL_TIME_ELAPSED queries, shaded fragments counted with a GL_SAMPLES_PASSED
+// query, and draw counts taken from the mesh arena. GPU queries rotate through
+// Latency sets and are only read once their result is available, so measuring
+// never stalls the pipeline; a result that is still pending when its set comes
+// round again is dropped.
+class PerfStats {
+public:
+    // CPU sections of a frame
+    enum class Cpu { Frame, Input, UiBuild, Swap, Count };
+    // GPU passes of a frame, measured one after another since timer queries cannot nest
+    enum class Gpu { DepthPrepass, BaldHead, Hair, Ui, Count };
+
+    // Frames a query set is in flight before it is read
+    static constexpr int Latency = 3;
+
+    // Times a CPU section until the end of the scope
+    class CpuScope {
+    private:
+        PerfStats& stats;
+        Cpu section;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        CpuScope(PerfStats& stats, Cpu section)
+            : stats(stats), section(section), start(std::chrono::steady_clock::now()) {
+        }
+        ~CpuScope() {
+            stats.cpu(section).add(milliseconds(start, std::chrono::steady_clock::now()));
+        }
+        CpuScope(const CpuScope&) = delete;
+        CpuScope& operator=(const CpuScope&) = delete;
+    };
+
+    // Times a GPU pass until the end of the scope
+    class GpuScope {
+    private:
+        PerfStats& stats;
+        bool started;   // False when nested in another pass, which cannot be timed
+
+    public:
+        GpuScope(PerfStats& stats, Gpu pass) : stats(stats), started(stats.beginPass(pass)) {
+        }
+        ~GpuScope() {
+            if (started) {
+                stats.endPass();
+            }
+        }
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator=(const GpuScope&) = delete;
+    };
+
+    // Counts the fragments passing the depth test until the end of the scope, i.e.
+    // the fragments shaded; meant for the shading pass, once per frame
+    class SampleScope {
+    private:
+        PerfStats& stats;
+        bool started;   // False when samples were already counted this frame
+
+    public:
+        explicit SampleScope(PerfStats& stats) : stats(stats), started(stats.beginSamples()) {
+        }
+        ~SampleScope() {
+            if (started) {
+                glEndQuery(GL_SAMPLES_PASSED);
+            }
+        }
+        SampleScope(const SampleScope&) = delete;
+        SampleScope& operator=(const SampleScope&) = delete;
+    };
+
+private:
+    static constexpr size_t CpuCount = static_cast<size_t>(Cpu::Count);
+    static constexpr size_t GpuCount = static_cast<size_t>(Gpu::Count);
+
+    // Queries of one frame
+    struct QuerySet {
+        std::array<GLQuery, GpuCount> queries;  // One timer per pass
+        std::array<bool, GpuCount> issued{};    // Whether the pass ran in that frame
+        GLQuery samples;                        // Fragments shaded
+        bool samplesIssued = false;             // Whether samples were counted in that frame
+    };
+
+    std::array<TimingSeries, CpuCount> cpuSeries;
+    std::array<TimingSeries, GpuCount> gpuSeries;
+    std::array<QuerySet, Latency> querySets;
+    int frameIndex;                                         // Frames begun so far
+    bool passActive;                                        // Whether a timer query is open
+    bool skipFrameTime;                                     // Whether the current frame's duration is not recorded
+    std::chrono::steady_clock::time_point frameStart;       // Start of the current frame
+    MeshArena::DrawStats draws;                             // Submissions of the last frame
+    uint64_t shadedSamples;                                 // Fragments shaded in the latest measured frame
+    std::vector<float> scratch;                             // Reused by percentile queries
+
+public:
+    PerfStats()
+        : frameIndex(0),
+        passActive(false),
+        skipFrameTime(false),
+        frameStart(std::chrono::steady_clock::now()),
+        shadedSamples(0) {
+        for (auto& set : querySets) {
+            for (auto& query : set.queries) {
+                query = GLQuery::create();
+            }
+            set.samples = GLQuery::create();
+        }
+    }
+
+    PerfStats(const PerfStats&) = delete;
+    PerfStats& operator=(const PerfStats&) = delete;
+
+    // Closes the previous frame: records its duration and draw counts, and
+    // collects the GPU timings of the query set about to be reused
+    void beginFrame(MeshArena& arena) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (frameIndex > 0 && !skipFrameTime) {
+            cpu(Cpu::Frame).add(milliseconds(frameStart, now));
+        }
+        frameStart = now;
+        skipFrameTime = false;
+        draws = arena.takeDrawStats();
+
+        QuerySet& set = querySets[frameIndex % Latency];
+        for (size_t pass = 0; pass < GpuCount; pass++) {
+            if (!set.issued[pass]) {
+                continue;
+            }
+            GLint available = 0;
+            glGetQueryObjectiv(set.queries[pass].get(), GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 nanoseconds = 0;
+                glGetQueryObjectui64v(set.queries[pass].get(), GL_QUERY_RESULT, &nanoseconds);
+                gpuSeries[pass].add(static_cast<float>(nanoseconds) * 1e-6f);
+            }
+            set.issued[pass] = false;
+        }
+        if (set.samplesIssued) {
+            GLint available = 0;
+            glGetQueryObjectiv(set.samples.get(), GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 samples = 0;
+                glGetQueryObjectui64v(set.samples.get(), GL_QUERY_RESULT, &samples);
+                shadedSamples = samples;
+            }
+            set.samplesIssued = false;
+        }
+        frameIndex++;
+    }
+
+    // Leaves the current frame out of the frame times, e.g. after it waited idle for events
+    void skipFrame() {
+        skipFrameTime = true;
+    }
+
+    // Draws the overlay window with timings, percentiles and draw counts
+    void renderOverlay(bool* open) {
+        ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - 10.0f, 10.0f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+        ImGui::SetNextWindowBgAlpha(0.75f);
+        if (!ImGui::Begin("Performance", open, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing |
+            ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoSavedSettings)) {
+            ImGui::End();
+            return;
+        }
+
+        const TimingSeries& frame = cpuSeries[static_cast<size_t>(Cpu::Frame)];
+        float average = frame.average();
+        ImGui::Text("Frame %.2f ms (%.0f fps)", average, average > 0.0f ? 1000.0f / average : 0.0f);
+        ImGui::PlotLines("##frame", frame.data(), static_cast<int>(frame.size()), static_cast<int>(frame.oldest()),
+            nullptr, 0.0f, std::max(33.4f, frame.percentile(0.99f, scratch)), ImVec2(260, 60));
+
+        ImGui::Separator();
+        ImGui::Text("%-10s %7s %7s %7s", "ms", "avg", "p95", "p99");
+        static const char* cpuNames[CpuCount] = { "Frame", "Input", "UI build", "Swap" };
+        for (size_t i = 0; i < CpuCount; i++) {
+            renderRow(cpuNames[i], cpuSeries[i]);
+        }
+        static const char* gpuNames[GpuCount] = { "GPU depth", "GPU head", "GPU hair", "GPU UI" };
+        for (size_t i = 0; i < GpuCount; i++) {
+            renderRow(gpuNames[i], gpuSeries[i]);
+        }
+
+        ImGui::Separator();
+        ImGui::Text("Draw calls %u (%u meshes)", draws.drawCalls, draws.meshDraws);
+        ImGui::Text("Triangles %llu", static_cast<unsigned long long>(draws.triangles));
+        ImGui::Text("Culled %u meshes, %u meshlets", draws.culledMeshes, draws.culledMeshlets);
+        // Overdraw: fragments shaded per framebuffer pixel
+        const ImGuiIO& io = ImGui::GetIO();
+        const double pixels = static_cast<double>(io.DisplaySize.x * io.DisplayFramebufferScale.x) *
+            static_cast<double>(io.DisplaySize.y * io.DisplayFramebufferScale.y);
+        ImGui::Text("Shaded fragments %llu (%.2f per pixel)", static_cast<unsigned long long>(shadedSamples),
+            pixels > 0.0 ? static_cast<double>(shadedSamples) / pixels : 0.0);
+        ImGui::End();
+    }
+
+private:
+    TimingSeries& cpu(Cpu section) { return cpuSeries[static_cast<size_t>(section)]; }
+
+    // Starts the timer query of a pass in the current frame's set, returns false
+    // if another pass is still open
+    bool beginPass(Gpu pass) {
+        if (passActive) {
+            return false;
+        }
+        QuerySet& set = querySets[(frameIndex + Latency - 1) % Latency];
+        glBeginQuery(GL_TIME_ELAPSED, set.queries[static_cast<size_t>(pass)].get());
+        set.issued[static_cast<size_t>(pass)] = true;
+        passActive = true;
+        return true;
+    }
+
+    // Starts the samples query in the current frame's set, returns false if it
+    // was already used this frame
+    bool beginSamples() {
+        QuerySet& set = querySets[(frameIndex + Latency - 1) % Latency];
+        if (set.samplesIssued) {
+            return false;
+        }
+        glBeginQuery(GL_SAMPLES_PASSED, set.samples.get());
+        set.samplesIssued = true;
+        return true;
+    }
+
+    void endPass() {
+        glEndQuery(GL_TIME_ELAPSED);
+        passActive = false;
+    }
+
+    void renderRow(const char* name, const TimingSeries& series) {
+        ImGui::Text("%-10s %7.2f %7.2f %7.2f", name, series.average(),
+            series.percentile(0.95f, scratch), series.percentile(0.99f, scratch));
+    }
+
+    static float milliseconds(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+        return std::chrono::duration<float, std::milli>(to - from).count();
+    }
+};
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <glm/glm.hpp>
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include "hair_transform.h"
+#include "atomic_file.h"
+
+// Placement of a hair model on a head, stored as a small JSON sidecar next to
+// the hair file ("<hair>.placement.json") so the hair geometry is never rewritten.
+// The content hash identifies the exact hair file the placement was made for.
+struct Placement {
+    static constexpr int FormatVersion = 1;
+
+    std::string modelPath;              // Hair model file
+    uint64_t contentHash = 0;           // Hash of the hair file contents, 0 if unknown
+    std::string headPath;               // Head model the hair was placed on
+    glm::vec3 position = glm::vec3(0.0f);
+    float rotationY = 0.0f;             // Yaw in degrees
+    float rotationX = 0.0f;             // Pitch in degrees
+    float rotationZ = 0.0f;             // Roll in degrees
+    float scale = 1.0f;
+    glm::vec3 color = glm::vec3(0.5f, 0.3f, 0.2f);
+
+    // Sidecar file holding the placement of a hair model
+    static std::string sidecarPath(const std::string& modelPath) {
+        return modelPath + ".placement.json";
+    }
+
+    // Captures the current transform of a hair model
+    static Placement capture(const HairTransform& transform, uint64_t contentHash, const std::string& headPath) {
+        Placement placement;
+        placement.modelPath = transform.getModelPath();
+        placement.contentHash = contentHash;
+        placement.headPath = headPath;
+        placement.position = transform.getPosition();
+        placement.rotationY = transform.getRotationY();
+        placement.rotationX = transform.getRotationX();
+        placement.rotationZ = transform.getRotationZ();
+        placement.scale = transform.getScale();
+        placement.color = transform.getColor();
+        return placement;
+    }
+
+    // Applies position, rotation, scale and color to a hair transform
+    void applyTo(HairTransform& transform) const {
+        transform.setPosition(position);
+        transform.setRotation(rotationY, rotationX, rotationZ);
+        transform.setScale(scale);
+        transform.setColor(color);
+    }
+
+    // Writes the placement as JSON, replacing the file atomically. The file is a
+    // few hundred bytes and is not flushed to disk, so saving stays in microseconds.
+    bool save(const std::string& path) const {
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        writer.SetFormatOptions(rapidjson::kFormatSingleLineArray);
+        char hash[17];
+        std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(contentHash));
+
+        writer.StartObject();
+        writer.Key("version");
+        writer.Int(FormatVersion);
+        writer.Key("model");
+        writer.String(modelPath.c_str());
+        // Hex string, JSON numbers cannot carry 64 bits reliably
+        writer.Key("contentHash");
+        writer.String(hash);
+        writer.Key("head");
+        writer.String(headPath.c_str());
+        writer.Key("position");
+        writeVec3(writer, position);
+        writer.Key("rotation");
+        writer.StartObject();
+        writer.Key("yaw");
+        writer.Double(shortest(rotationY));
+        writer.Key("pitch");
+        writer.Double(shortest(rotationX));
+        writer.Key("roll");
+        writer.Double(shortest(rotationZ));
+        writer.EndObject();
+        writer.Key("scale");
+        writer.Double(shortest(scale));
+        writer.Key("color");
+        writeVec3(writer, color);
+        writer.EndObject();
+
+        return AtomicFile::write(path, buffer.GetString(), buffer.GetSize(), false);
+    }
+
+    // Reads a placement, returns false if the file is missing or malformed
+    bool load(const std::string& path) {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        rapidjson::Document document;
+        document.Parse(json.c_str());
+        if (document.HasParseError() || !document.IsObject()) {
+            std::cout << "Placement: cannot parse " << path << std::endl;
+            return false;
+        }
+        if (!document.HasMember("version") || !document["version"].IsInt() ||
+            document["version"].GetInt() > FormatVersion) {
+            std::cout << "Placement: unsupported version in " << path << std::endl;
+            return false;
+        }
+
+        Placement result;
+        if (!readString(document, "model", result.modelPath) || !result.readTransform(document)) {
+            std::cout << "Placement: missing or invalid fields in " << path << std::endl;
+            return false;
+        }
+        readString(document, "head", result.headPath);
+        std::string hash;
+        if (readString(document, "contentHash", hash)) {
+            result.contentHash = std::strtoull(hash.c_str(), nullptr, 16);
+        }
+
+        *this = result;
+        return true;
+    }
+
+    // Reads position, rotation, scale and, if present, color from a JSON object
+    // laid out like the sidecar file. Leaves the placement unchanged on failure.
+    bool readTransform(const rapidjson::Value& object) {
+        Placement result = *this;
+        if (!object.IsObject() ||
+            !readVec3(object, "position", result.position) ||
+            !readFloat(object, "scale", result.scale) ||
+            !object.HasMember("rotation") || !object["rotation"].IsObject()) {
+            return false;
+        }
+        const rapidjson::Value& rotation = object["rotation"];
+        if (!readFloat(rotation, "yaw", result.rotationY) ||
+            !readFloat(rotation, "pitch", result.rotationX) ||
+            !readFloat(rotation, "roll", result.rotationZ)) {
+            return false;
+        }
+        if (object.HasMember("color") && !readVec3(object, "color", result.color)) {
+            return false;
+        }
+        *this = result;
+        return true;
+    }
+
+    // Model matrix of the placement, as HairTransform builds it
+    glm::mat4 getModelMatrix() const {
+        HairTransform transform;
+        applyTo(transform);
+        return transform.getModelMatrix();
+    }
+
+    // Applies the sidecar placement of a hair model if there is one. A placement
+    // made for other file contents is skipped: the file may have been baked with
+    // it, and applying it again would move the hair twice.
+    static bool restore(const std::string& modelPath, uint64_t contentHash, HairTransform& transform) {
+        Placement placement;
+        if (!placement.load(sidecarPath(modelPath))) {
+            return false;
+        }
+        if (placement.contentHash != 0 && contentHash != 0 && placement.contentHash != contentHash) {
+            std::cout << "Placement: " << modelPath << " changed since its placement was saved, ignoring it" << std::endl;
+            return false;
+        }
+        placement.applyTo(transform);
+        return true;
+    }
+
+private:
+    // Double with the shortest decimal form of a float, so 0.7f is written as 0.7
+    // rather than the 0.699999988... of its exact double value
+    static double shortest(float value) {
+        char text[32];
+        auto result = std::to_chars(text, text + sizeof(text) - 1, value);
+        *result.ptr = '\0';
+        return std::strtod(text, nullptr);
+    }
+
+    template <typename Writer>
+    static void writeVec3(Writer& writer, const glm::vec3& value) {
+        writer.StartArray();
+        writer.Double(shortest(value.x));
+        writer.Double(shortest(value.y));
+        writer.Double(shortest(value.z));
+        writer.EndArray();
+    }
+
+    static bool readString(const rapidjson::Value& object, const char* name, std::string& value) {
+        if (!object.HasMember(name) || !object[name].IsString()) return false;
+        value = object[name].GetString();
+        return true;
+    }
+
+    static bool readFloat(const rapidjson::Value& object, const char* name, float& value) {
+        if (!object.HasMember(name) || !object[name].IsNumber()) return false;
+        value = static_cast<float>(object[name].GetDouble());
+        return true;
+    }
+
+    static bool readVec3(const rapidjson::Value& object, const char* name, glm::vec3& value) {
+        if (!object.HasMember(name) || !object[name].IsArray() || object[name].Size() != 3) return false;
+        const rapidjson::Value& array = object[name];
+        for (rapidjson::SizeType i = 0; i < 3; i++) {
+            if (!array[i].IsNumber()) return false;
+            value[i] = static_cast<float>(array[i].GetDouble());
+        }
+        return true;
+    }
+};
+
+#endif
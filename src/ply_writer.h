@@ -0,0 +1,116 @@
+#ifndef PLY_WRITER_H
+#define PLY_WRITER_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "mesh_data.h"
+#include "atomic_file.h"
+
+// Binary little-endian PLY exporter. Vertices are transformed and triangles
+// packed into fixed-size staging chunks that stream through an AtomicFile::Writer,
+// so memory stays at a few MB however large the model is. All meshes go into a
+// single vertex and face list.
+class PlyWriter {
+private:
+    // Vertices transformed per chunk, 1.5 MB of output
+    static constexpr size_t ChunkVertices = 1 << 16;
+    // Triangles packed per chunk, 13 bytes each
+    static constexpr size_t ChunkFaces = 1 << 16;
+    // Size of one face record: uchar count followed by three uint indices
+    static constexpr size_t FaceBytes = 1 + 3 * sizeof(uint32_t);
+
+public:
+    // Writes all meshes with the transform applied to positions and normals.
+    // Returns false if the file cannot be written, the old file then stays intact.
+    // Progress, if given, is the fraction of written elements.
+    static bool write(const std::string& path, const std::vector<MeshData>& meshes, const glm::mat4& transform,
+        std::atomic<float>* progress = nullptr) {
+        size_t vertexCount = 0, faceCount = 0;
+        for (const auto& mesh : meshes) {
+            vertexCount += mesh.vertices.size();
+            faceCount += mesh.indices.size() / 3;
+        }
+        if (vertexCount > std::numeric_limits<uint32_t>::max()) {
+            std::cout << "PLY export: too many vertices for 32-bit indices" << std::endl;
+            return false;
+        }
+
+        AtomicFile::Writer file(path);
+        const std::string header =
+            "ply\n"
+            "format binary_little_endian 1.0\n"
+            "element vertex " + std::to_string(vertexCount) + "\n"
+            "property float x\n"
+            "property float y\n"
+            "property float z\n"
+            "property float nx\n"
+            "property float ny\n"
+            "property float nz\n"
+            "element face " + std::to_string(faceCount) + "\n"
+            "property list uchar uint vertex_indices\n"
+            "end_header\n";
+        file.write(header.data(), header.size());
+
+        // Vertex is six packed floats, exactly the PLY vertex record; the mesh
+        // cache already relies on the host being little-endian
+        static_assert(sizeof(Vertex) == 6 * sizeof(float), "Vertex must match the PLY vertex record");
+        const glm::mat3 normalTransform = normalMatrix(transform);
+        const size_t total = std::max<size_t>(1, vertexCount + faceCount);
+        size_t written = 0;
+        std::vector<Vertex> vertexChunk(std::min(ChunkVertices, vertexCount));
+        for (const auto& mesh : meshes) {
+            for (size_t begin = 0; begin < mesh.vertices.size() && file.good(); begin += ChunkVertices) {
+                size_t count = std::min(ChunkVertices, mesh.vertices.size() - begin);
+                transformVertices(mesh.vertices.data() + begin, count, transform, normalTransform, vertexChunk.data());
+                file.write(vertexChunk.data(), count * sizeof(Vertex));
+                reportProgress(progress, written += count, total);
+            }
+        }
+        std::vector<Vertex>().swap(vertexChunk);
+
+        std::vector<unsigned char> faceChunk(std::min(ChunkFaces, faceCount) * FaceBytes);
+        uint32_t vertexOffset = 0;
+        for (const auto& mesh : meshes) {
+            const size_t meshFaces = mesh.indices.size() / 3;
+            for (size_t begin = 0; begin < meshFaces && file.good(); begin += ChunkFaces) {
+                size_t count = std::min(ChunkFaces, meshFaces - begin);
+                unsigned char* out = faceChunk.data();
+                for (size_t t = begin; t < begin + count; t++) {
+                    uint32_t face[3] = {
+                        mesh.indices[t * 3] + vertexOffset,
+                        mesh.indices[t * 3 + 1] + vertexOffset,
+                        mesh.indices[t * 3 + 2] + vertexOffset
+                    };
+                    *out = 3;
+                    std::memcpy(out + 1, face, sizeof(face));
+                    out += FaceBytes;
+                }
+                file.write(faceChunk.data(), count * FaceBytes);
+                reportProgress(progress, written += count, total);
+            }
+            vertexOffset += static_cast<uint32_t>(mesh.vertices.size());
+        }
+
+        if (!file.commit()) {
+            std::cout << "PLY export: cannot write " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static void reportProgress(std::atomic<float>* progress, size_t written, size_t total) {
+        if (progress) {
+            *progress = static_cast<float>(written) / static_cast<float>(total);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,295 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <ctime>
+#include <string>
+
+// Scoped CPU instrumentation written as a Chrome / Perfetto trace (open the file
+// in chrome://tracing or ui.perfetto.dev). Compiled in only when HAIR_PROFILER is
+// defined (CMake option HAIR_ENABLE_PROFILER); otherwise the macros expand to
+// nothing and writeTrace() only reports that tracing is unavailable.
+//
+//   PROFILE_SCOPE("name")          times the enclosing scope
+//   PROFILE_COUNTER("name", value) records a value on a counter track
+//   PROFILE_THREAD_NAME("name")    labels the calling thread in the trace
+//
+// Names must be string literals, only their pointers are stored. Every thread
+// records into its own ring buffer holding the latest Capacity events, so
+// recording takes no shared lock and a long session keeps only recent history.
+
+#ifdef HAIR_PROFILER
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "atomic_file.h"
+
+class Profiler {
+public:
+    static constexpr bool Enabled = true;
+    // Events kept per thread, 32 bytes each
+    static constexpr size_t Capacity = 1 << 16;
+    // Buffers of finished threads kept for the trace, older ones are dropped
+    static constexpr size_t RetiredBuffers = 16;
+
+private:
+    enum class EventType : uint32_t { Scope, Counter };
+
+    struct Event {
+        const char* name;
+        uint64_t start;         // Nanoseconds since the profiler epoch
+        union {
+            uint64_t duration;  // Scope length in nanoseconds
+            double value;       // Counter value
+        };
+        EventType type;
+    };
+
+    // Ring buffer of one thread. Only the owner writes; the mutex is uncontended
+    // except while a trace is being copied out.
+    struct ThreadBuffer {
+        std::mutex mutex;
+        std::vector<Event> events;
+        size_t next = 0;            // Slot the next event goes to
+        size_t count = 0;           // Valid events, at most Capacity
+        uint32_t id = 0;            // Trace thread id
+        std::string name;
+        bool retired = false;       // Whether the owning thread has exited
+    };
+
+    // Process-wide registry of thread buffers
+    struct State {
+        std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+        std::mutex mutex;                                   // Guards buffers and nextId
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers; // In registration order
+        uint32_t nextId = 1;
+    };
+
+    // Registers the calling thread's buffer on first use, retires it at thread exit
+    struct ThreadSlot {
+        std::shared_ptr<ThreadBuffer> buffer;
+
+        ThreadSlot() : buffer(std::make_shared<ThreadBuffer>()) {
+            buffer->events.resize(Capacity);
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            buffer->id = s.nextId++;
+            buffer->name = "Thread " + std::to_string(buffer->id);
+            s.buffers.push_back(buffer);
+            pruneRetired(s);
+        }
+        ~ThreadSlot() {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            buffer->retired = true;
+        }
+    };
+
+    static State& state() {
+        static State instance;
+        return instance;
+    }
+
+    static ThreadBuffer& threadBuffer() {
+        thread_local ThreadSlot slot;
+        return *slot.buffer;
+    }
+
+    // Drops the oldest buffers of exited threads beyond RetiredBuffers, state mutex held
+    static void pruneRetired(State& s) {
+        size_t retired = 0;
+        for (const auto& buffer : s.buffers) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            retired += buffer->retired ? 1 : 0;
+        }
+        for (auto it = s.buffers.begin(); it != s.buffers.end() && retired > RetiredBuffers;) {
+            bool drop;
+            {
+                std::lock_guard<std::mutex> lock((*it)->mutex);
+                drop = (*it)->retired;
+            }
+            if (drop) {
+                it = s.buffers.erase(it);
+                retired--;
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    static void record(const Event& event) {
+        ThreadBuffer& buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.events[buffer.next] = event;
+        buffer.next = (buffer.next + 1) % Capacity;
+        if (buffer.count < Capacity) {
+            buffer.count++;
+        }
+    }
+
+public:
+    // Nanoseconds since the profiler epoch
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - state().epoch).count());
+    }
+
+    // Times the enclosing scope, use through PROFILE_SCOPE
+    class Scope {
+    private:
+        const char* name;
+        uint64_t start;
+
+    public:
+        explicit Scope(const char* name) : name(name), start(now()) {}
+        ~Scope() {
+            Event event;
+            event.name = name;
+            event.start = start;
+            event.duration = now() - start;
+            event.type = EventType::Scope;
+            record(event);
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // Records a counter sample at the current time
+    static void counter(const char* name, double value) {
+        Event event;
+        event.name = name;
+        event.start = now();
+        event.value = value;
+        event.type = EventType::Counter;
+        record(event);
+    }
+
+    // Names the calling thread in the trace
+    static void setThreadName(const char* name) {
+        ThreadBuffer& buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.name = name;
+    }
+
+    // Writes the buffered events of all threads as Chrome trace JSON, replacing
+    // the file atomically. Recording continues meanwhile; each thread is only
+    // paused while its buffer is copied.
+    static bool writeTrace(const std::string& path) {
+        rapidjson::StringBuffer json;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(json);
+        writer.StartObject();
+        writer.Key("displayTimeUnit");
+        writer.String("ms");
+        writer.Key("traceEvents");
+        writer.StartArray();
+
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            buffers = s.buffers;
+        }
+        std::vector<Event> events;
+        size_t total = 0;
+        for (const auto& buffer : buffers) {
+            std::string name;
+            uint32_t id;
+            {
+                std::lock_guard<std::mutex> lock(buffer->mutex);
+                const size_t oldest = buffer->count < Capacity ? 0 : buffer->next;
+                events.resize(buffer->count);
+                for (size_t i = 0; i < buffer->count; i++) {
+                    events[i] = buffer->events[(oldest + i) % Capacity];
+                }
+                name = buffer->name;
+                id = buffer->id;
+            }
+
+            writer.StartObject();
+            writer.Key("name"); writer.String("thread_name");
+            writer.Key("ph"); writer.String("M");
+            writer.Key("pid"); writer.Uint(1);
+            writer.Key("tid"); writer.Uint(id);
+            writer.Key("args");
+            writer.StartObject();
+            writer.Key("name"); writer.String(name.c_str());
+            writer.EndObject();
+            writer.EndObject();
+
+            for (const auto& event : events) {
+                writer.StartObject();
+                writer.Key("name"); writer.String(event.name);
+                writer.Key("pid"); writer.Uint(1);
+                writer.Key("tid"); writer.Uint(id);
+                writer.Key("ts"); writer.Double(static_cast<double>(event.start) * 1e-3);
+                if (event.type == EventType::Scope) {
+                    writer.Key("ph"); writer.String("X");
+                    writer.Key("dur"); writer.Double(static_cast<double>(event.duration) * 1e-3);
+                }
+                else {
+                    writer.Key("ph"); writer.String("C");
+                    writer.Key("args");
+                    writer.StartObject();
+                    writer.Key("value"); writer.Double(event.value);
+                    writer.EndObject();
+                }
+                writer.EndObject();
+            }
+            total += events.size();
+        }
+
+        writer.EndArray();
+        writer.EndObject();
+
+        if (!AtomicFile::write(path, json.GetString(), json.GetSize())) {
+            std::cout << "Profiler: cannot write " << path << std::endl;
+            return false;
+        }
+        std::cout << "Profiler: wrote " << total << " events from " << buffers.size()
+            << " threads to " << path << std::endl;
+        return true;
+    }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) Profiler::counter(name, static_cast<double>(value))
+#define PROFILE_THREAD_NAME(name) Profiler::setThreadName(name)
+
+#else
+
+#include <iostream>
+
+// Stand-in when profiling is compiled out
+class Profiler {
+public:
+    static constexpr bool Enabled = false;
+
+    static bool writeTrace(const std::string& path) {
+        (void)path;
+        std::cout << "Profiler: not compiled in, configure with -DHAIR_ENABLE_PROFILER=ON" << std::endl;
+        return false;
+    }
+};
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_COUNTER(name, value) ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+
+#endif
+
+// Default trace file name, stamped with the local time so dumps do not overwrite each other
+inline std::string profilerTracePath() {
+    std::time_t now = std::time(nullptr);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+    return std::string("trace-") + stamp + ".json";
+}
+
+#endif
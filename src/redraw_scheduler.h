@@ -0,0 +1,205 @@
+#ifndef REDRAW_SCHEDULER_H
+#define REDRAW_SCHEDULER_H
+
+#include <GLFW/glfw3.h>
+#include <bitset>
+
+// Decides whether the render loop needs another frame. Window events (input,
+// resize, expose, focus) mark the scene dirty and so do callers that notice a
+// change; the loop renders while anything is dirty and otherwise blocks in
+// glfwWaitEventsTimeout without drawing or swapping, so the last presented frame
+// stays on screen. Every change is followed by a few settle frames because ImGui
+// reacts to input one frame late (hover, layout).
+//
+// The callbacks are installed on top of the ones already set (ImGui's and the
+// input manager's) and forward to them, so install after those.
+class RedrawScheduler {
+public:
+    // Frames rendered after a change so ImGui layout and hover state catch up
+    static constexpr int SettleFrames = 3;
+    // Wait while idle before checking again, seconds
+    static constexpr double IdleTimeout = 0.5;
+    // Frame interval while busy, enough for progress bars, seconds
+    static constexpr double BusyInterval = 0.1;
+
+private:
+    int pendingFrames;                              // Frames still to render
+    bool continuous;                                // Render every frame regardless of changes
+    bool busy;                                      // Render at BusyInterval while otherwise idle
+    std::bitset<GLFW_KEY_LAST + 1> keysDown;        // Held keys, drive continuous movement
+    std::bitset<GLFW_MOUSE_BUTTON_LAST + 1> buttonsDown; // Held mouse buttons, e.g. slider drags
+
+    // Callbacks that were installed before, called after recording the event
+    struct Chain {
+        GLFWkeyfun key = nullptr;
+        GLFWcharfun character = nullptr;
+        GLFWmousebuttonfun mouseButton = nullptr;
+        GLFWcursorposfun cursorPos = nullptr;
+        GLFWcursorenterfun cursorEnter = nullptr;
+        GLFWscrollfun scroll = nullptr;
+        GLFWframebuffersizefun framebufferSize = nullptr;
+        GLFWwindowrefreshfun refresh = nullptr;
+        GLFWwindowfocusfun focus = nullptr;
+        GLFWwindowiconifyfun iconify = nullptr;
+    };
+    Chain chain;
+
+    // The callbacks are global, the application has a single window
+    static RedrawScheduler*& instance() {
+        static RedrawScheduler* current = nullptr;
+        return current;
+    }
+
+public:
+    RedrawScheduler() : pendingFrames(SettleFrames), continuous(false), busy(false) {
+    }
+
+    ~RedrawScheduler() {
+        if (instance() == this) {
+            instance() = nullptr;
+        }
+    }
+
+    RedrawScheduler(const RedrawScheduler&) = delete;
+    RedrawScheduler& operator=(const RedrawScheduler&) = delete;
+
+    // Installs the event callbacks on the window, chaining to existing ones
+    void install(GLFWwindow* window) {
+        instance() = this;
+        chain.key = glfwSetKeyCallback(window, onKey);
+        chain.character = glfwSetCharCallback(window, onChar);
+        chain.mouseButton = glfwSetMouseButtonCallback(window, onMouseButton);
+        chain.cursorPos = glfwSetCursorPosCallback(window, onCursorPos);
+        chain.cursorEnter = glfwSetCursorEnterCallback(window, onCursorEnter);
+        chain.scroll = glfwSetScrollCallback(window, onScroll);
+        chain.framebufferSize = glfwSetFramebufferSizeCallback(window, onFramebufferSize);
+        chain.refresh = glfwSetWindowRefreshCallback(window, onRefresh);
+        chain.focus = glfwSetWindowFocusCallback(window, onFocus);
+        chain.iconify = glfwSetWindowIconifyCallback(window, onIconify);
+    }
+
+    // Requests frames after a change the scheduler cannot see itself
+    void invalidate(int frames = SettleFrames) {
+        if (frames > pendingFrames) {
+            pendingFrames = frames;
+        }
+    }
+
+    // Renders every frame while set, e.g. while a live statistics display is open
+    void setContinuous(bool enabled) { continuous = enabled; }
+
+    // Renders at BusyInterval while set, e.g. while background work reports progress
+    void setBusy(bool enabled) { busy = enabled; }
+
+    // Whether the next loop iteration has to render
+    bool needsFrame() const {
+        return continuous || pendingFrames > 0 || keysDown.any() || buttonsDown.any();
+    }
+
+    // Accounts for a rendered frame
+    void frameRendered() {
+        if (pendingFrames > 0) {
+            pendingFrames--;
+        }
+    }
+
+    // Processes pending events, then blocks until a frame is needed or the window
+    // should close. Returns true if it blocked, the time spent then belongs to no frame.
+    bool waitForFrame(GLFWwindow* window) {
+        glfwPollEvents();
+        bool waited = false;
+        while (!needsFrame() && !glfwWindowShouldClose(window)) {
+            glfwWaitEventsTimeout(busy ? BusyInterval : IdleTimeout);
+            if (busy) {
+                invalidate(1);
+            }
+            waited = true;
+        }
+        return waited;
+    }
+
+private:
+    static void onKey(GLFWwindow* window, int key, int scancode, int action, int mods) {
+        if (RedrawScheduler* self = instance()) {
+            if (key >= 0 && key <= GLFW_KEY_LAST && action != GLFW_REPEAT) {
+                self->keysDown[key] = action == GLFW_PRESS;
+            }
+            self->invalidate();
+            if (self->chain.key) self->chain.key(window, key, scancode, action, mods);
+        }
+    }
+
+    static void onChar(GLFWwindow* window, unsigned int codepoint) {
+        if (RedrawScheduler* self = instance()) {
+            self->invalidate();
+            if (self->chain.character) self->chain.character(window, codepoint);
+        }
+    }
+
+    static void onMouseButton(GLFWwindow* window, int button, int action, int mods) {
+        if (RedrawScheduler* self = instance()) {
+            if (button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST) {
+                self->buttonsDown[button] = action == GLFW_PRESS;
+            }
+            self->invalidate();
+            if (self->chain.mouseButton) self->chain.mouseButton(window, button, action, mods);
+        }
+    }
+
+    static void onCursorPos(GLFWwindow* window, double x, double y) {
+        if (RedrawScheduler* self = instance()) {
+            self->invalidate();
+            if (self->chain.cursorPos) self->chain.cursorPos(window, x, y);
+        }
+    }
+
+    static void onCursorEnter(GLFWwindow* window, int entered) {
+        if (RedrawScheduler* self = instance()) {
+            self->invalidate();
+            if (self->chain.cursorEnter) self->chain.cursorEnter(window, entered);
+        }
+    }
+
+    static void onScroll(GLFWwindow* window, double x, double y) {
+        if (RedrawScheduler* self = instance()) {
+            self->invalidate();
+            if (self->chain.scroll) self->chain.scroll(window, x, y);
+        }
+    }
+
+    static void onFramebufferSize(GLFWwindow* window, int width, int height) {
+        if (RedrawScheduler* self = instance()) {
+            self->invalidate();
+            if (self->chain.framebufferSize) self->chain.framebufferSize(window, width, height);
+        }
+    }
+
+    // The window was exposed or damaged and its content has to be drawn again
+    static void onRefresh(GLFWwindow* window) {
+        if (RedrawScheduler* self = instance()) {
+            self->invalidate();
+            if (self->chain.refresh) self->chain.refresh(window);
+        }
+    }
+
+    // Losing focus releases held keys and buttons, GLFW does not always report it
+    static void onFocus(GLFWwindow* window, int focused) {
+        if (RedrawScheduler* self = instance()) {
+            if (!focused) {
+                self->keysDown.reset();
+                self->buttonsDown.reset();
+            }
+            self->invalidate();
+            if (self->chain.focus) self->chain.focus(window, focused);
+        }
+    }
+
+    static void onIconify(GLFWwindow* window, int iconified) {
+        if (RedrawScheduler* self = instance()) {
+            self->invalidate();
+            if (self->chain.iconify) self->chain.iconify(window, iconified);
+        }
+    }
+};
+
+#endif
@@ -3,13 +3,31 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
-// Class to manage OpenGL shader programs
+// Class to manage OpenGL shader programs. Active uniform locations are looked up
+// once after linking, and every setter keeps a shadow copy of the last value it
+// uploaded so repeated identical values cost no GL call.
 class Shader {
+private:
+    // Active uniform outside any uniform block
+    struct Uniform {
+        GLint location;     // Location in the program
+        bool hasValue;      // Whether value holds what the program currently has
+        float value[16];    // Shadow of the last uploaded value, ints stored bitwise
+    };
+
+    std::map<std::string, Uniform, std::less<>> uniforms; // Active uniforms by name, searchable by string_view
+
 public:
     unsigned int ID; // Shader program ID
 
@@ -64,24 +82,108 @@ public:
         // Clean up shader objects
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+
+        reflectUniforms();
     }
 
+    // Shadow values belong to the program, so shaders are neither copied nor moved
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
     // Activates the shader program for rendering
     void use() const {
         glUseProgram(ID);
     }
 
-    // Sets a 4x4 matrix uniform in the shader
-    void setMat4(const std::string& name, const glm::mat4& mat) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    // Sets a 4x4 matrix uniform in the shader, the program must be in use
+    void setMat4(std::string_view name, const glm::mat4& mat) {
+        if (Uniform* uniform = changed(name, &mat[0][0], sizeof(glm::mat4))) {
+            glUniformMatrix4fv(uniform->location, 1, GL_FALSE, &mat[0][0]);
+        }
+    }
+
+    // Sets a 3x3 matrix uniform in the shader, the program must be in use
+    void setMat3(std::string_view name, const glm::mat3& mat) {
+        if (Uniform* uniform = changed(name, &mat[0][0], sizeof(glm::mat3))) {
+            glUniformMatrix3fv(uniform->location, 1, GL_FALSE, &mat[0][0]);
+        }
+    }
+
+    // Sets a 3D vector uniform in the shader, the program must be in use
+    void setVec3(std::string_view name, const glm::vec3& value) {
+        if (Uniform* uniform = changed(name, &value[0], sizeof(glm::vec3))) {
+            glUniform3fv(uniform->location, 1, &value[0]);
+        }
+    }
+
+    // Sets an integer or boolean uniform in the shader, the program must be in use
+    void setInt(std::string_view name, int value) {
+        if (Uniform* uniform = changed(name, &value, sizeof(int))) {
+            glUniform1i(uniform->location, value);
+        }
     }
 
-    // Sets a 3D vector uniform in the shader
-    void setVec3(const std::string& name, const glm::vec3& value) const {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    // Connects a uniform block to a buffer binding point, returns false if the
+    // program has no active block of that name
+    bool bindUniformBlock(const char* name, GLuint binding) {
+        GLuint index = glGetUniformBlockIndex(ID, name);
+        if (index == GL_INVALID_INDEX) {
+            return false;
+        }
+        glUniformBlockBinding(ID, index, binding);
+        return true;
     }
 
 private:
+    // Caches the locations of all active uniforms outside uniform blocks
+    void reflectUniforms() {
+        GLint linked = 0, count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            return;
+        }
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> name(static_cast<size_t>(std::max(maxLength, 1)));
+        for (GLuint i = 0; i < static_cast<GLuint>(count); i++) {
+            // Block members are set through their buffer
+            GLint block = -1;
+            glGetActiveUniformsiv(ID, 1, &i, GL_UNIFORM_BLOCK_INDEX, &block);
+            if (block != -1) {
+                continue;
+            }
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+            std::string uniformName(name.data(), static_cast<size_t>(length));
+            // Arrays are reported as "name[0]", the setters use the plain name
+            if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0) {
+                uniformName.resize(uniformName.size() - 3);
+            }
+            Uniform uniform = {};
+            uniform.location = glGetUniformLocation(ID, name.data());
+            uniform.hasValue = false;
+            uniforms[uniformName] = uniform;
+        }
+    }
+
+    // Returns the uniform if value differs from its shadow and updates the shadow,
+    // null if the value is unchanged or the uniform is not active
+    Uniform* changed(std::string_view name, const void* value, size_t size) {
+        auto found = uniforms.find(name);
+        if (found == uniforms.end()) {
+            return nullptr;
+        }
+        Uniform& uniform = found->second;
+        if (uniform.hasValue && std::memcmp(uniform.value, value, size) == 0) {
+            return nullptr;
+        }
+        std::memcpy(uniform.value, value, size);
+        uniform.hasValue = true;
+        return &uniform;
+    }
+
     // Checks for compilation or linking errors in shaders or programs
     void checkCompileErrors(unsigned int shader, std::string type) {
         int success;
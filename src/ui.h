@@ -11,8 +11,15 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <filesystem>
 #include "model.h"
+#include "model_loader.h"
+#include "model_saver.h"
+#include "placement.h"
 #include "hair_transform.h"
+#include "perf_stats.h"
+#include "overdraw_view.h"
+#include "profiler.h"
 
 // Class to manage the ImGui user interface for hair model adjustments
 class UI {
@@ -22,20 +29,42 @@ private:
     bool* renderBald;             // Pointer to bald rendering toggle
     bool* renderHair;             // Pointer to hair rendering toggle
     bool* mouseLocked;            // Pointer to mouse lock state
+    bool* compactVertices;        // Pointer to compact vertex format toggle
     HairTransform* hairTransform; // Pointer to hair transformation data
     Model* hairModel;             // Pointer to hair model
+    ModelLoader* modelLoader;     // Pointer to background model loader
+    ModelSaver* modelSaver;       // Pointer to background model saver
+    SaveSettings saveSettings;    // OBJ precision and Draco quantization for saves
+    std::string saveStatus;       // Outcome of the last save, shown under the save button
+    std::string bakePath;         // Hair file of the bake in flight, empty if none
+    std::string headPath;         // Head model referenced by saved placements
+    PerfStats* perfStats;         // Frame statistics for the overlay, null if not measured
+    bool showPerformance;         // Whether the performance overlay is open
+    bool cullOpenBackFaces;       // Whether back-facing meshlets of open meshes are skipped too
+    bool depthPrepass;            // Whether depth is laid down before shading
+    OverdrawView* overdrawView;   // Overdraw heat map settings and metrics, null if unavailable
+    bool* overdrawMode;           // Pointer to overdraw heat map toggle
 
 public:
     // Constructor initializes UI with references to external states
-    UI(bool* wireframeMode, bool* renderBald, bool* renderHair, bool* mouseLocked,
-        HairTransform* hairTransform, Model* hairModel)
+    UI(bool* wireframeMode, bool* renderBald, bool* renderHair, bool* mouseLocked, bool* compactVertices,
+        HairTransform* hairTransform, Model* hairModel, ModelLoader* modelLoader, ModelSaver* modelSaver)
         : showSaveConfirmation(false),
         wireframeMode(wireframeMode),
         renderBald(renderBald),
         renderHair(renderHair),
         mouseLocked(mouseLocked),
+        compactVertices(compactVertices),
         hairTransform(hairTransform),
-        hairModel(hairModel) {
+        hairModel(hairModel),
+        modelLoader(modelLoader),
+        modelSaver(modelSaver),
+        perfStats(nullptr),
+        showPerformance(false),
+        cullOpenBackFaces(false),
+        depthPrepass(false),
+        overdrawView(nullptr),
+        overdrawMode(nullptr) {
     }
 
     // Initializes ImGui context and backends
@@ -63,6 +92,7 @@ public:
 
     // Renders the main UI window with hair adjustment controls
     void renderUI(float deltaTime) {
+        PROFILE_SCOPE("UI::renderUI");
         ImGui::Begin("Hair Adjustment");
 
         // Debug mouse and window state when mouse is unlocked
@@ -85,11 +115,21 @@ public:
         if (ImGui::Button("Select Hair Model")) {
             IGFD::FileDialogConfig config;
             config.path = "models/";
-            ImGuiFileDialog::Instance()->OpenDialog("ChooseHairDlgKey", "Select Hair Model", ".obj,.ply", config);
+            ImGuiFileDialog::Instance()->OpenDialog("ChooseHairDlgKey", "Select Hair Model", ".obj,.ply,.glb,.drc", config);
         }
 
         ImGui::SameLine();
-        ImGui::Text("Current: %s", hairTransform->getModelPath().c_str());
+        ImGui::Text("Current: %s", hasHair() ? hairTransform->getModelPath().c_str() : "(none)");
+
+        // Background load progress, the current hair stays visible meanwhile
+        if (modelLoader->isLoading()) {
+            ImGui::Text("Loading: %s", modelLoader->getLoadingPath().c_str());
+            ImGui::ProgressBar(modelLoader->getProgress(), ImVec2(200, 0));
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel")) {
+                modelLoader->cancel();
+            }
+        }
 
         // Handle file dialog for model selection
         handleFileDialog();
@@ -106,20 +146,78 @@ public:
         renderScaleControls(deltaTime);
         renderRotationControls(deltaTime);
 
+        // GPU vertex layout, compact halves vertex memory and bandwidth
+        ImGui::Checkbox("Compact vertex format", compactVertices);
+
+        // Closed meshes always skip back-facing meshlets; open ones such as hair
+        // cards show their back faces, so skipping them there is a choice
+        ImGui::Checkbox("Cull back faces of open meshes", &cullOpenBackFaces);
+
+        // Shades only the nearest surface of each pixel, for a second geometry pass;
+        // compare the shaded fragments in the performance overlay
+        ImGui::Checkbox("Depth pre-pass", &depthPrepass);
+
         // Reset transformation button
         if (ImGui::Button("Reset to Auto Position")) {
             hairTransform->reset(1.0f);
         }
 
-        // Save model button
-        if (ImGui::Button("Save Hair Model")) {
+        // Placement, baking and exports need a loaded hair file
+        ImGui::BeginDisabled(!hasHair());
+
+        // Placement sidecar, the hair file itself stays untouched
+        if (ImGui::Button("Save Placement")) {
+            std::string path = Placement::sidecarPath(hairTransform->getModelPath());
+            Placement placement = Placement::capture(*hairTransform, hairModel->getContentHash(), headPath);
+            saveStatus = (placement.save(path) ? "Saved placement: " : "Placement save failed: ") + path;
+            std::cout << saveStatus << std::endl;
+        }
+
+        // Explicit export baking the transform into the hair geometry,
+        // OBJ output uses the chosen number of decimals
+        ImGui::SliderInt("OBJ Decimals", &saveSettings.objPrecision, 1, ObjWriter::MaxPrecision);
+        if (ImGui::Button("Bake Into Hair File")) {
             showSaveConfirmation = true;
         }
+        ImGui::EndDisabled();
+
+        // Background save progress, rendering and editing continue meanwhile
+        std::string savedPath;
+        bool saved;
+        while (modelSaver->takeResult(savedPath, saved)) {
+            saveStatus = (saved ? "Saved: " : "Save failed: ") + savedPath;
+            std::cout << saveStatus << std::endl;
+            if (savedPath == bakePath) {
+                finishBake(saved);
+            }
+        }
+        if (modelSaver->isSaving()) {
+            ImGui::Text("Saving: %s", modelSaver->getSavingPath().c_str());
+            ImGui::ProgressBar(modelSaver->getProgress(), ImVec2(200, 0));
+        }
+        else if (!saveStatus.empty()) {
+            ImGui::Text("%s", saveStatus.c_str());
+        }
+
+        // Exports next to the current hair file, never over it
+        renderExportControls();
+
+        // Frame timings overlay
+        if (perfStats) {
+            ImGui::Checkbox("Performance Overlay", &showPerformance);
+        }
+
+        // Depth complexity heat map and its metrics
+        renderOverdrawControls();
 
         // Handle save confirmation popup
         handleSaveConfirmation();
 
         ImGui::End();
+
+        if (perfStats && showPerformance) {
+            perfStats->renderOverlay(&showPerformance);
+        }
     }
 
     // Renders ImGui draw data
@@ -128,6 +226,68 @@ public:
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     }
 
+    // Swaps in a finished background load, call once per frame before drawing.
+    // Returns true if a load finished, successfully or not.
+    bool applyLoadedModel() {
+        std::string path;
+        std::vector<MeshData> meshes;
+        uint64_t contentHash;
+        if (!modelLoader->takeResult(path, meshes, contentHash)) {
+            return false;
+        }
+        if (meshes.empty()) {
+            std::cout << "Failed to load hair model: " << path << std::endl;
+            return true;
+        }
+        *hairModel = Model(std::move(meshes), hairModel->getArena(),
+            *compactVertices ? VertexFormat::Compact : VertexFormat::Float, contentHash);
+        // Close the gap the previous hair left in the shared buffers
+        hairModel->getArena().compact();
+        hairTransform->setModelPath(path);
+        // Restore the saved placement of this hair, if any
+        if (!Placement::restore(path, contentHash, *hairTransform)) {
+            hairTransform->reset(1.0f);
+        }
+        std::cout << "Loaded hair model: " << path << std::endl;
+        return true;
+    }
+
+    // Sets the head model referenced by saved placements
+    void setHeadPath(const std::string& path) {
+        headPath = path;
+    }
+
+    // Sets the frame statistics shown by the performance overlay
+    void setPerfStats(PerfStats* stats) {
+        perfStats = stats;
+    }
+
+    // Sets the overdraw view and its toggle, which the 'H' key also flips
+    void setOverdrawView(OverdrawView* view, bool* enabled) {
+        overdrawView = view;
+        overdrawMode = enabled;
+    }
+
+    // Whether background work is reporting progress that has to be redrawn
+    bool isBusy() const {
+        return modelLoader->isLoading() || modelSaver->isSaving();
+    }
+
+    // Whether back-facing meshlets of open meshes should be skipped
+    bool getCullOpenBackFaces() const {
+        return cullOpenBackFaces;
+    }
+
+    // Whether a depth-only pass should run before the shading pass
+    bool getDepthPrepass() const {
+        return depthPrepass;
+    }
+
+    // Whether the performance overlay is open, it needs continuous frames to measure
+    bool isPerformanceOverlayShown() const {
+        return perfStats && showPerformance;
+    }
+
     // Cleans up ImGui resources
     void cleanup() {
         ImGui_ImplOpenGL3_Shutdown();
@@ -143,10 +303,8 @@ private:
                 std::string path = ImGuiFileDialog::Instance()->GetFilePathName();
                 std::ifstream file(path);
                 if (file.good()) {
-                    hairTransform->setModelPath(path);
-                    *hairModel = Model(path.c_str());
-                    std::cout << "Loaded hair model: " << path << std::endl;
-                    hairTransform->reset(1.0f);
+                    modelLoader->request(path);
+                    std::cout << "Loading hair model: " << path << std::endl;
                 }
                 else {
                     std::cout << "Failed to load hair model: " << path << std::endl;
@@ -325,16 +483,100 @@ private:
         }
     }
 
+    // Renders the export buttons and Draco quantization settings
+    void renderExportControls() {
+        if (!ImGui::CollapsingHeader("Export")) {
+            return;
+        }
+        ImGui::BeginDisabled(!hasHair());
+        if (ImGui::Button("Export as .ply")) {
+            exportHair(".ply");
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Export as .glb")) {
+            exportHair(".glb");
+        }
+        ImGui::SliderInt("Position Bits", &saveSettings.draco.positionBits, 8, 20);
+        ImGui::SliderInt("Normal Bits", &saveSettings.draco.normalBits, 6, 16);
+        if (ImGui::Button("Export as .drc")) {
+            exportHair(".drc");
+        }
+        ImGui::EndDisabled();
+    }
+
+    // Renders the overdraw heat map toggle, its display settings and the depth
+    // complexity of both models in the latest measured frame
+    void renderOverdrawControls() {
+        if (!overdrawView || !ImGui::CollapsingHeader("Overdraw")) {
+            return;
+        }
+        ImGui::Checkbox("Heat map (H)", overdrawMode);
+        int shown = static_cast<int>(overdrawView->getShown()) - 1;
+        if (ImGui::Combo("Layers", &shown, "Head\0Hair\0Both\0")) {
+            overdrawView->setShown(static_cast<OverdrawView::Layer>(shown + 1));
+        }
+        int heatScale = overdrawView->getHeatScale();
+        if (ImGui::SliderInt("Red at", &heatScale, 2, 64)) {
+            overdrawView->setHeatScale(heatScale);
+        }
+        if (!*overdrawMode || !overdrawView->hasMeasurement()) {
+            return;
+        }
+        // Fragments per covered pixel, hidden ones included since depth is not tested
+        const float pixels = static_cast<float>(overdrawView->getMeasuredPixels());
+        const OverdrawView::Complexity* layers[2] = { &overdrawView->getHead(), &overdrawView->getHair() };
+        const char* names[2] = { "Head", "Hair" };
+        for (int i = 0; i < 2; i++) {
+            ImGui::Text("%s: avg %.2f, max %u, covers %.1f%%", names[i], layers[i]->average(), layers[i]->maximum,
+                100.0f * static_cast<float>(layers[i]->coveredPixels) / pixels);
+        }
+    }
+
+    // Whether a hair model was loaded from a file, the startup hair may be empty
+    bool hasHair() const {
+        return !hairModel->getMeshData()->empty() && !hairTransform->getModelPath().empty();
+    }
+
+    // Queues a save of the transformed hair next to its file as <stem>_export<ext>.
+    // Never writes the hair file itself, baking into it needs the confirmation.
+    void exportHair(const char* extension) {
+        std::filesystem::path source(hairTransform->getModelPath());
+        std::filesystem::path target = source;
+        target.replace_filename(source.stem().string() + "_export" + extension);
+        std::error_code error;
+        if (target == source || std::filesystem::equivalent(target, source, error)) {
+            saveStatus = "Export refused, it would overwrite the hair file: " + target.string();
+            std::cout << saveStatus << std::endl;
+            return;
+        }
+        modelSaver->request(hairModel->getMeshData(), target.string(), hairTransform->getModelMatrix(), saveSettings);
+    }
+
+    // Removes the placement sidecar of a baked hair file, the file now holds the
+    // transform and the placement must not be applied on top of it
+    void finishBake(bool saved) {
+        if (saved) {
+            std::string sidecar = Placement::sidecarPath(bakePath);
+            std::error_code error;
+            if (std::filesystem::remove(sidecar, error)) {
+                std::cout << "Removed placement baked into the hair: " << sidecar << std::endl;
+            }
+        }
+        bakePath.clear();
+    }
+
     // Handles save confirmation popup
     void handleSaveConfirmation() {
         if (showSaveConfirmation) {
             ImGui::OpenPopup("Save Confirmation");
             if (ImGui::BeginPopupModal("Save Confirmation", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
-                ImGui::Text("Are you sure you want to overwrite the original hair file?\nThis action cannot be undone.");
+                ImGui::Text("Bake the current transform into the hair geometry and overwrite the original hair file?\nThis action cannot be undone. Use \"Save Placement\" to keep the file untouched.");
 
                 if (ImGui::Button("Yes", ImVec2(120, 0))) {
+                    // Snapshot the mesh data and matrix, the worker replaces the file atomically
                     glm::mat4 transformMatrix = hairTransform->getModelMatrix();
-                    hairModel->saveToOBJ(hairTransform->getModelPath(), transformMatrix);
+                    bakePath = hairTransform->getModelPath();
+                    modelSaver->request(hairModel->getMeshData(), bakePath, transformMatrix, saveSettings);
                     showSaveConfirmation = false;
                     ImGui::CloseCurrentPopup();
                 }
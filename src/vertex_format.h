@@ -0,0 +1,96 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "mesh_data.h"
+
+// GPU vertex layouts a mesh can be uploaded in
+enum class VertexFormat {
+    Float,   // Vertex as is: 2 x vec3, 24 bytes, 32-bit indices
+    Compact  // CompactVertex: 12 bytes, 16-bit indices
+};
+
+// Quantized vertex: position as 16-bit unsigned normalized integers relative to
+// the mesh bounds, normal octahedral-encoded into two signed bytes
+struct CompactVertex {
+    uint16_t Position[4]; // x, y, z, padding for 4-byte alignment
+    int8_t Normal[2];     // Octahedral normal
+    int8_t Padding[2];
+};
+
+// Largest vertex count addressable with 16-bit indices
+constexpr size_t CompactMaxVertices = 65536;
+
+// Dequantization parameters: position = offset + quantized * scale
+struct QuantizationBox {
+    glm::vec3 offset = glm::vec3(0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+};
+
+// Quantization box covering all vertices of a mesh
+inline QuantizationBox computeQuantizationBox(const std::vector<Vertex>& vertices) {
+    QuantizationBox box;
+    if (vertices.empty()) {
+        return box;
+    }
+    glm::vec3 minimum(vertices[0].Position), maximum(vertices[0].Position);
+    for (const auto& vertex : vertices) {
+        minimum = glm::min(minimum, vertex.Position);
+        maximum = glm::max(maximum, vertex.Position);
+    }
+    box.offset = minimum;
+    // Flat axes keep a non-zero scale so decoding never divides by zero
+    box.scale = glm::max(maximum - minimum, glm::vec3(1e-12f));
+    return box;
+}
+
+// Quantization box covering all vertices of several meshes
+inline QuantizationBox computeQuantizationBox(const std::vector<MeshData>& meshes) {
+    QuantizationBox box;
+    bool first = true;
+    glm::vec3 minimum(0.0f), maximum(0.0f);
+    for (const auto& mesh : meshes) {
+        for (const auto& vertex : mesh.vertices) {
+            minimum = first ? vertex.Position : glm::min(minimum, vertex.Position);
+            maximum = first ? vertex.Position : glm::max(maximum, vertex.Position);
+            first = false;
+        }
+    }
+    if (first) {
+        return box;
+    }
+    box.offset = minimum;
+    box.scale = glm::max(maximum - minimum, glm::vec3(1e-12f));
+    return box;
+}
+
+// Encodes a unit normal into octahedral coordinates in [-1, 1]
+inline glm::vec2 octahedralEncode(const glm::vec3& normal) {
+    glm::vec3 n = normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+    glm::vec2 encoded(n.x, n.y);
+    if (n.z < 0.0f) {
+        encoded = glm::vec2((1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+            (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+    }
+    return encoded;
+}
+
+// Packs a vertex into the compact layout
+inline CompactVertex packCompactVertex(const Vertex& vertex, const QuantizationBox& box) {
+    CompactVertex packed = {};
+    glm::vec3 unit = glm::clamp((vertex.Position - box.offset) / box.scale, glm::vec3(0.0f), glm::vec3(1.0f));
+    for (int i = 0; i < 3; i++) {
+        packed.Position[i] = static_cast<uint16_t>(std::lround(unit[i] * 65535.0f));
+    }
+    glm::vec2 octahedral = octahedralEncode(vertex.Normal);
+    for (int i = 0; i < 2; i++) {
+        packed.Normal[i] = static_cast<int8_t>(std::lround(glm::clamp(octahedral[i], -1.0f, 1.0f) * 127.0f));
+    }
+    return packed;
+}
+
+#endif
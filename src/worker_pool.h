@@ -0,0 +1,112 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent worker threads for short parallel loops that run every frame, where
+// starting threads each time (as the importers and exporters do) would cost more
+// than the work. The calling thread takes part in every loop.
+class WorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;               // Signals a new loop or shutdown
+    std::condition_variable finished;           // Signals the last worker leaving a loop
+    const std::function<void(size_t)>* body;    // Loop body of the current loop
+    size_t count;                               // Iterations of the current loop
+    std::atomic<size_t> next;                   // Next iteration to hand out
+    size_t running;                             // Workers still inside the current loop
+    uint64_t generation;                        // Loops started so far
+    bool stopping;
+
+public:
+    // Starts threadCount workers, 0 for one per core besides the caller
+    explicit WorkerPool(unsigned int threadCount = 0)
+        : body(nullptr), count(0), next(0), running(0), generation(0), stopping(false) {
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        }
+        for (unsigned int i = 0; i < threadCount; i++) {
+            threads.emplace_back([this]() { work(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Threads working on a loop, including the caller
+    size_t size() const { return threads.size() + 1; }
+
+    // Runs body(i) for every i below n and returns once all have finished.
+    // Iterations are handed out one at a time, so uneven ones balance out.
+    void parallelFor(size_t n, const std::function<void(size_t)>& loopBody) {
+        if (threads.empty() || n < 2) {
+            for (size_t i = 0; i < n; i++) {
+                loopBody(i);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            body = &loopBody;
+            count = n;
+            next = 0;
+            running = threads.size();
+            generation++;
+        }
+        wake.notify_all();
+        for (size_t i = next++; i < n; i = next++) {
+            loopBody(i);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() { return running == 0; });
+        body = nullptr;
+    }
+
+private:
+    // Worker loop, joins every loop started after it went to sleep
+    void work() {
+        uint64_t seen = 0;
+        while (true) {
+            const std::function<void(size_t)>* loopBody;
+            size_t n;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+                loopBody = body;
+                n = count;
+            }
+            for (size_t i = next++; i < n; i = next++) {
+                (*loopBody)(i);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--running == 0) {
+                finished.notify_one();
+            }
+        }
+    }
+};
+
+#endif